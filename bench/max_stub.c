@@ -0,0 +1,239 @@
+//==============================================================================
+//
+//  @file max_stub.c
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief Minimal stand-in for the Max API, for the benchmarks.
+//
+//  Symbols, atoms, memory and object allocation work as in Max, and the
+//  memory calls are counted. Outlets discard their output, object_free()
+//  only frees the memory, and the rest does nothing.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "max_stub.h"
+#include "ext_buffer.h"
+#include "ext_dictobj.h"
+#include "jit.common.h"
+#include <stdarg.h>
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+#define SYMBOLS_MAX 256
+
+//==============================================================================
+//  Variables
+//==============================================================================
+
+t_uint64 stub_alloc_cnt = 0;
+
+// The only class: objects are allocated with its size
+struct _class { long size; };
+static t_class stub_class;
+
+static t_symbol stub_symbols[SYMBOLS_MAX];
+static int stub_symbol_cnt = 0;
+
+t_symbol* _jit_sym_float32 = NULL;
+t_symbol* _jit_sym_float64 = NULL;
+t_symbol* _jit_sym_lock = NULL;
+t_symbol* _jit_sym_getinfo = NULL;
+t_symbol* _jit_sym_getdata = NULL;
+t_symbol* _jit_sym_jit_matrix = NULL;
+t_symbol* _jit_sym_class_jit_matrix = NULL;
+
+//==============================================================================
+//  Symbols, atoms and memory
+//==============================================================================
+
+t_symbol* gensym(const char* name) {
+
+  for (int i = 0; i < stub_symbol_cnt; i++) {
+    if (!strcmp(stub_symbols[i].s_name, name)) { return stub_symbols + i; }
+  }
+  if (stub_symbol_cnt == SYMBOLS_MAX) {
+    fprintf(stderr, "gensym: Too many symbols.\n");
+    exit(1);
+  }
+  stub_symbols[stub_symbol_cnt].s_name = strdup(name);
+  return stub_symbols + stub_symbol_cnt++;
+}
+
+short atom_gettype(const t_atom* a) { return a->a_type; }
+
+t_atom_long atom_getlong(const t_atom* a) {
+  if (a->a_type == A_LONG) { return a->a_w.w_long; }
+  if (a->a_type == A_FLOAT) { return (t_atom_long)a->a_w.w_float; }
+  return 0;
+}
+
+t_atom_float atom_getfloat(const t_atom* a) {
+  if (a->a_type == A_FLOAT) { return a->a_w.w_float; }
+  if (a->a_type == A_LONG) { return (t_atom_float)a->a_w.w_long; }
+  return 0;
+}
+
+t_symbol* atom_getsym(const t_atom* a) {
+  return (a->a_type == A_SYM) ? a->a_w.w_sym : gensym("");
+}
+
+void* atom_getobj(const t_atom* a) {
+  return (a->a_type == A_OBJ) ? a->a_w.w_obj : NULL;
+}
+
+t_max_err atom_setlong(t_atom* a, t_atom_long val) {
+  a->a_type = A_LONG;
+  a->a_w.w_long = val;
+  return MAX_ERR_NONE;
+}
+
+t_max_err atom_setfloat(t_atom* a, double val) {
+  a->a_type = A_FLOAT;
+  a->a_w.w_float = val;
+  return MAX_ERR_NONE;
+}
+
+t_max_err atom_setsym(t_atom* a, t_symbol* sym) {
+  a->a_type = A_SYM;
+  a->a_w.w_sym = sym;
+  return MAX_ERR_NONE;
+}
+
+char* sysmem_newptr(long size) {
+  stub_alloc_cnt++;
+  return malloc(size);
+}
+
+char* sysmem_resizeptr(void* ptr, long size) {
+  stub_alloc_cnt++;
+  return realloc(ptr, size);
+}
+
+void sysmem_freeptr(void* ptr) { free(ptr); }
+
+//==============================================================================
+//  Console
+//==============================================================================
+
+void object_warn(t_object* x, const char* fmt, ...) {
+
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "warning: ");
+  vfprintf(stderr, fmt, args);
+  fprintf(stderr, "\n");
+  va_end(args);
+}
+
+void error(const char* fmt, ...) {
+
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "error: ");
+  vfprintf(stderr, fmt, args);
+  fprintf(stderr, "\n");
+  va_end(args);
+}
+
+//==============================================================================
+//  Outlets: the output is discarded
+//==============================================================================
+
+void* outlet_new(void* x, const char* type) { return NULL; }
+void* outlet_int(void* outlet, t_atom_long val) { return NULL; }
+void* outlet_float(void* outlet, double val) { return NULL; }
+
+void* outlet_list(void* outlet, t_symbol* sym, short argc, t_atom* argv) {
+  return NULL;
+}
+
+void* outlet_anything(void* outlet, t_symbol* sym, short argc, t_atom* argv) {
+  return NULL;
+}
+
+//==============================================================================
+//  Everything else does nothing
+//==============================================================================
+
+t_class* class_new(const char* name, method mnew, method mfree, long size,
+  method mmenu, short type, ...) {
+  stub_class.size = size;
+  return &stub_class;
+}
+t_max_err class_addmethod(t_class* c, method m, const char* name, ...) {
+  return MAX_ERR_NONE;
+}
+t_max_err class_register(t_symbol* space, t_class* c) { return MAX_ERR_NONE; }
+void* object_alloc(t_class* c) { return calloc(1, c->size); }
+void object_free(void* x) { free(x); }
+void* object_method(void* x, t_symbol* sym, ...) { return NULL; }
+t_symbol* object_classname(void* x) { return gensym(""); }
+t_max_err object_attr_setlong(void* x, t_symbol* name, t_atom_long val) {
+  return MAX_ERR_NONE;
+}
+t_max_err object_attr_setchar(void* x, t_symbol* name, char val) {
+  return MAX_ERR_NONE;
+}
+void attr_args_process(void* x, short argc, t_atom* argv) {}
+
+long systhread_create(method m, void* arg, unsigned long stack, int prio,
+  long flags, t_systhread* thread) { return 1; }
+long systhread_join(t_systhread thread, unsigned int* ret) { return 0; }
+void systhread_exit(long status) {}
+void* qelem_new(void* x, method m) { return NULL; }
+void qelem_set(void* q) {}
+void qelem_free(void* q) {}
+
+t_max_err atomarray_getatoms(t_atomarray* x, long* argc, t_atom** argv) {
+  *argc = 0;
+  *argv = NULL;
+  return MAX_ERR_NONE;
+}
+
+t_buffer_ref* buffer_ref_new(t_object* x, t_symbol* name) { return NULL; }
+void buffer_ref_set(t_buffer_ref* ref, t_symbol* name) {}
+t_buffer_obj* buffer_ref_getobject(t_buffer_ref* ref) { return NULL; }
+t_max_err buffer_ref_notify(t_buffer_ref* ref, t_symbol* sym, t_symbol* msg,
+  void* sender, void* data) { return MAX_ERR_NONE; }
+float* buffer_locksamples(t_buffer_obj* buf) { return NULL; }
+void buffer_unlocksamples(t_buffer_obj* buf) {}
+t_atom_long buffer_getframecount(t_buffer_obj* buf) { return 0; }
+t_atom_long buffer_getchannelcount(t_buffer_obj* buf) { return 0; }
+t_max_err buffer_setdirty(t_buffer_obj* buf) { return MAX_ERR_NONE; }
+
+t_dictionary* dictobj_findregistered_retain(t_symbol* name) { return NULL; }
+t_max_err dictobj_release(t_dictionary* d) { return MAX_ERR_NONE; }
+t_max_err dictionary_getkeys(t_dictionary* d, long* cnt, t_symbol*** keys) {
+  *cnt = 0;
+  *keys = NULL;
+  return MAX_ERR_NONE;
+}
+void dictionary_freekeys(t_dictionary* d, long cnt, t_symbol** keys) {}
+long dictionary_entryisatomarray(t_dictionary* d, t_symbol* key) { return 0; }
+long dictionary_entryisdictionary(t_dictionary* d, t_symbol* key) { return 0; }
+t_max_err dictionary_getatomarray(t_dictionary* d, t_symbol* key,
+  t_object** val) { return MAX_ERR_GENERIC; }
+t_max_err dictionary_getdictionary(t_dictionary* d, t_symbol* key,
+  t_object** val) { return MAX_ERR_GENERIC; }
+t_max_err dictionary_getatom(t_dictionary* d, t_symbol* key, t_atom* val) {
+  return MAX_ERR_GENERIC;
+}
+t_max_err dictionary_appendatom(t_dictionary* d, t_symbol* key, t_atom* val) {
+  return MAX_ERR_NONE;
+}
+
+void* jit_object_findregistered(t_symbol* name) { return NULL; }
+void* jit_object_method(void* x, t_symbol* sym, ...) { return NULL; }
+void jit_parallel_ndim_simplecalc1(method m, void* data, long dimcount,
+  long* dim, long planecount, t_jit_matrix_info* minfo, char* bp,
+  long flags) {}
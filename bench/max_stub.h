@@ -0,0 +1,22 @@
+//==============================================================================
+//
+//  @file max_stub.h
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief Counters of the Max API stand-in, for the benchmarks.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+#ifndef YC_BENCH_MAX_STUB_H_
+#define YC_BENCH_MAX_STUB_H_
+
+#include "ext.h"
+
+// Number of calls to sysmem_newptr() and sysmem_resizeptr()
+extern t_uint64 stub_alloc_cnt;
+
+#endif
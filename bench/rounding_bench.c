@@ -0,0 +1,129 @@
+//==============================================================================
+//
+//  @file rounding_bench.c
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief Headless throughput benchmark of the rounding list loop.
+//
+//  Builds one rounding external, ROUND_SOURCE, against the Max API
+//  stand-in, and calls process_message() with an outlet that discards the
+//  result. Sweeps the list length, the type mix and the clip or chunk mode,
+//  and prints the throughput and the memory calls per message.
+//
+//  Usage: rounding_bench_<name> [calls per case]
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include ROUND_SOURCE
+#include "max_stub.h"
+#include <time.h>
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+// Default number of calls per case, and chunk size in chunk mode
+#define BENCH_ITER 1000
+#define BENCH_CHUNK 1024
+
+//==============================================================================
+//  Function definitions
+//==============================================================================
+
+//******************************************************************************
+//  Monotonic time in seconds.
+//
+static double bench_time(void) {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//******************************************************************************
+//  Fill the input: longs, floats, or floats, longs and symbols.
+//
+static void bench_fill(t_atom* atoms, long cnt, int mix) {
+
+  t_symbol* sym = gensym("sym");
+
+  for (long i = 0; i < cnt; i++) {
+    double val = (i % 1000) * 0.37 - 185.0;
+    switch ((mix == 2) ? i % 3 : mix) {
+    case 0: atom_setlong(atoms + i, (t_atom_long)val); break;
+    case 1: atom_setfloat(atoms + i, val); break;
+    default: atom_setsym(atoms + i, sym); break;
+    }
+  }
+}
+
+//******************************************************************************
+//  Run the sweep.
+//
+int main(int argc, char** argv) {
+
+  static const long lengths[] =
+    { 1, 4, 16, 64, 256, 1024, 4096, 16384, SHRT_MAX };
+  static const char* mixes[] = { "long", "float", "mixed" };
+
+  long iter = (argc > 1) ? atol(argv[1]) : BENCH_ITER;
+  if (iter < 1) {
+    fprintf(stderr, "usage: %s [calls per case]\n", argv[0]);
+    return 1;
+  }
+
+  // Create the object as Max would, then set the attributes directly
+  ext_main(NULL);
+  t_rounding* x = (t_rounding*)rounding_new(gensym(ROUND_NAME), 0, NULL);
+  t_atom* input = (t_atom*)malloc(SHRT_MAX * sizeof(t_atom));
+  if (!x || !input) {
+    fprintf(stderr, "Allocation failed.\n");
+    return 1;
+  }
+  x->a_maxlen = SHRT_MAX;
+  x->a_verbose = 1;
+  x->a_markers = 0;
+#ifdef ROUND_STEP
+  x->a_step = 0.25;
+#endif
+
+  t_symbol* list = gensym("list");
+  printf("y.%s: %ld calls per case\n", ROUND_NAME, iter);
+  printf("%-5s %-5s %6s %12s %12s\n",
+    "mode", "mix", "atoms", "Matoms/s", "allocs/call");
+
+  for (int chunked = 0; chunked < 2; chunked++) {
+    x->a_chunk = chunked ? BENCH_CHUNK : 0;
+
+    for (int mix = 0; mix < 3; mix++) {
+      bench_fill(input, SHRT_MAX, mix);
+
+      for (int l = 0; l < (int)(sizeof(lengths) / sizeof(long)); l++) {
+        t_uint64 alloc_cnt = stub_alloc_cnt;
+        double time = bench_time();
+        for (long i = 0; i < iter; i++) {
+          rounding_list(x, list, lengths[l], input);
+        }
+        time = MAX(bench_time() - time, 1e-9);
+
+        printf("%-5s %-5s %6ld %12.2f %12.3f\n",
+          chunked ? "chunk" : "clip", mixes[mix], lengths[l],
+          (double)lengths[l] * iter / time * 1e-6,
+          (double)(stub_alloc_cnt - alloc_cnt) / iter);
+      }
+    }
+  }
+
+  rounding_free(x);
+  object_free(x);
+  free(input);
+  return 0;
+}
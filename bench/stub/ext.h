@@ -0,0 +1,131 @@
+//==============================================================================
+//
+//  @file ext.h
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief Minimal stand-in for the Max SDK headers, for the benchmarks.
+//
+//  Declares only what the rounding engine uses, with the SDK names and
+//  types. The definitions are in max_stub.c: atoms and memory work, and
+//  the rest does nothing. The other SDK headers include this one.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+#ifndef YC_BENCH_STUB_EXT_H_
+#define YC_BENCH_STUB_EXT_H_
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//==============================================================================
+//  Types
+//==============================================================================
+
+typedef unsigned char t_uint8;
+typedef unsigned int t_uint32;
+typedef long long t_int64;
+typedef unsigned long long t_uint64;
+typedef long long t_atom_long;
+typedef double t_atom_float;
+typedef long t_max_err;
+typedef long t_bool;
+typedef void* (*method)(void*, ...);
+
+typedef struct _symbol { char* s_name; } t_symbol;
+typedef struct _object { void* o_messlist; } t_object;
+typedef struct _class t_class;
+typedef struct _systhread* t_systhread;
+
+typedef struct _atom {
+  short a_type;
+  union {
+    t_atom_long w_long;
+    double w_float;
+    t_symbol* w_sym;
+    t_object* w_obj;
+  } a_w;
+} t_atom;
+
+enum { A_NOTHING, A_LONG, A_FLOAT, A_SYM, A_OBJ, A_GIMME = 8, A_CANT };
+enum { ASSIST_INLET = 1, ASSIST_OUTLET };
+enum { MAX_ERR_NONE = 0, MAX_ERR_GENERIC = -1 };
+
+//==============================================================================
+//  Macros
+//==============================================================================
+
+#define C74_EXPORT
+#define CLASS_BOX gensym("box")
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define true 1
+#define false 0
+
+#define CLASS_ATTR_CHAR(c, n, f, T, m) ((void)0)
+#define CLASS_ATTR_ATOM_LONG(c, n, f, T, m) ((void)0)
+#define CLASS_ATTR_DOUBLE(c, n, f, T, m) ((void)0)
+#define CLASS_ATTR_ORDER(c, n, f, v) ((void)0)
+#define CLASS_ATTR_LABEL(c, n, f, v) ((void)0)
+#define CLASS_ATTR_STYLE(c, n, f, v) ((void)0)
+#define CLASS_ATTR_SAVE(c, n, f) ((void)0)
+#define CLASS_ATTR_SELFSAVE(c, n, f) ((void)0)
+#define CLASS_ATTR_ACCESSORS(c, n, g, s) ((void)(s))
+
+//==============================================================================
+//  Functions
+//==============================================================================
+
+// Classes and objects
+t_symbol* gensym(const char* name);
+t_class* class_new(const char* name, method mnew, method mfree, long size,
+  method mmenu, short type, ...);
+t_max_err class_addmethod(t_class* c, method m, const char* name, ...);
+t_max_err class_register(t_symbol* space, t_class* c);
+void* object_alloc(t_class* c);
+void object_free(void* x);
+void* object_method(void* x, t_symbol* sym, ...);
+t_symbol* object_classname(void* x);
+t_max_err object_attr_setlong(void* x, t_symbol* name, t_atom_long val);
+t_max_err object_attr_setchar(void* x, t_symbol* name, char val);
+void attr_args_process(void* x, short argc, t_atom* argv);
+void object_warn(t_object* x, const char* fmt, ...);
+void error(const char* fmt, ...);
+
+// Outlets
+void* outlet_new(void* x, const char* type);
+void* outlet_int(void* outlet, t_atom_long val);
+void* outlet_float(void* outlet, double val);
+void* outlet_list(void* outlet, t_symbol* sym, short argc, t_atom* argv);
+void* outlet_anything(void* outlet, t_symbol* sym, short argc, t_atom* argv);
+
+// Memory
+char* sysmem_newptr(long size);
+char* sysmem_resizeptr(void* ptr, long size);
+void sysmem_freeptr(void* ptr);
+
+// Atoms
+short atom_gettype(const t_atom* a);
+t_atom_long atom_getlong(const t_atom* a);
+t_atom_float atom_getfloat(const t_atom* a);
+t_symbol* atom_getsym(const t_atom* a);
+void* atom_getobj(const t_atom* a);
+t_max_err atom_setlong(t_atom* a, t_atom_long val);
+t_max_err atom_setfloat(t_atom* a, double val);
+t_max_err atom_setsym(t_atom* a, t_symbol* sym);
+
+// Threads and queues
+long systhread_create(method m, void* arg, unsigned long stack, int prio,
+  long flags, t_systhread* thread);
+long systhread_join(t_systhread thread, unsigned int* ret);
+void systhread_exit(long status);
+void* qelem_new(void* x, method m);
+void qelem_set(void* q);
+void qelem_free(void* q);
+
+#endif
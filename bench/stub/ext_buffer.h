@@ -0,0 +1,20 @@
+#ifndef YC_BENCH_STUB_EXT_BUFFER_H_
+#define YC_BENCH_STUB_EXT_BUFFER_H_
+
+#include "ext.h"
+
+typedef struct _buffer_ref t_buffer_ref;
+typedef t_object t_buffer_obj;
+
+t_buffer_ref* buffer_ref_new(t_object* x, t_symbol* name);
+void buffer_ref_set(t_buffer_ref* ref, t_symbol* name);
+t_buffer_obj* buffer_ref_getobject(t_buffer_ref* ref);
+t_max_err buffer_ref_notify(t_buffer_ref* ref, t_symbol* sym, t_symbol* msg,
+  void* sender, void* data);
+float* buffer_locksamples(t_buffer_obj* buf);
+void buffer_unlocksamples(t_buffer_obj* buf);
+t_atom_long buffer_getframecount(t_buffer_obj* buf);
+t_atom_long buffer_getchannelcount(t_buffer_obj* buf);
+t_max_err buffer_setdirty(t_buffer_obj* buf);
+
+#endif
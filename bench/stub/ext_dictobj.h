@@ -0,0 +1,21 @@
+#ifndef YC_BENCH_STUB_EXT_DICTOBJ_H_
+#define YC_BENCH_STUB_EXT_DICTOBJ_H_
+
+#include "ext_obex.h"
+
+typedef struct _dictionary t_dictionary;
+
+t_dictionary* dictobj_findregistered_retain(t_symbol* name);
+t_max_err dictobj_release(t_dictionary* d);
+t_max_err dictionary_getkeys(t_dictionary* d, long* cnt, t_symbol*** keys);
+void dictionary_freekeys(t_dictionary* d, long cnt, t_symbol** keys);
+long dictionary_entryisatomarray(t_dictionary* d, t_symbol* key);
+long dictionary_entryisdictionary(t_dictionary* d, t_symbol* key);
+t_max_err dictionary_getatomarray(t_dictionary* d, t_symbol* key,
+  t_object** val);
+t_max_err dictionary_getdictionary(t_dictionary* d, t_symbol* key,
+  t_object** val);
+t_max_err dictionary_getatom(t_dictionary* d, t_symbol* key, t_atom* val);
+t_max_err dictionary_appendatom(t_dictionary* d, t_symbol* key, t_atom* val);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef YC_BENCH_STUB_EXT_OBEX_H_
+#define YC_BENCH_STUB_EXT_OBEX_H_
+
+#include "ext.h"
+
+typedef struct _atomarray t_atomarray;
+
+t_max_err atomarray_getatoms(t_atomarray* x, long* argc, t_atom** argv);
+
+#endif
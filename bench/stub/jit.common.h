@@ -0,0 +1,30 @@
+#ifndef YC_BENCH_STUB_JIT_COMMON_H_
+#define YC_BENCH_STUB_JIT_COMMON_H_
+
+#include "ext.h"
+
+typedef struct _jit_matrix_info {
+  long size;
+  t_symbol* type;
+  long flags;
+  long dimcount;
+  long dim[32];
+  long dimstride[32];
+  long planecount;
+} t_jit_matrix_info;
+
+extern t_symbol* _jit_sym_float32;
+extern t_symbol* _jit_sym_float64;
+extern t_symbol* _jit_sym_lock;
+extern t_symbol* _jit_sym_getinfo;
+extern t_symbol* _jit_sym_getdata;
+extern t_symbol* _jit_sym_jit_matrix;
+extern t_symbol* _jit_sym_class_jit_matrix;
+
+void* jit_object_findregistered(t_symbol* name);
+void* jit_object_method(void* x, t_symbol* sym, ...);
+void jit_parallel_ndim_simplecalc1(method m, void* data, long dimcount,
+  long* dim, long planecount, t_jit_matrix_info* minfo, char* bp,
+  long flags);
+
+#endif
@@ -0,0 +1,101 @@
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "ambi.h"
+#include <math.h>
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+#define DEG_TO_RAD 0.0174532925199432957692
+
+// Index of degree n and order m >= 0 in the triangular Legendre arrays
+#define AMBI_TRI(n, m) ((n) * ((n) + 1) / 2 + (m))
+
+#define AMBI_TRI_CNT AMBI_TRI(AMBI_ORDER_MAX + 1, 0)
+
+//==============================================================================
+//  Static variables
+//==============================================================================
+
+//******************************************************************************
+//  SN3D normalization factors, built on the first call.
+//
+static double ambi_sn3d[AMBI_TRI_CNT];
+static t_bool ambi_sn3d_init = false;
+
+//==============================================================================
+//  Function definitions
+//==============================================================================
+
+//******************************************************************************
+//  Build the SN3D factors: sqrt((2 - delta(m)) * (n - m)! / (n + m)!).
+//
+static void ambi_build_sn3d(void) {
+
+  for (int n = 0; n <= AMBI_ORDER_MAX; n++) {
+    for (int m = 0; m <= n; m++) {
+      double ratio = 1;
+      for (int k = n - m + 1; k <= n + m; k++) {
+        ratio /= k;
+      }
+      ambi_sn3d[AMBI_TRI(n, m)] = sqrt((m ? 2.0 : 1.0) * ratio);
+    }
+  }
+  ambi_sn3d_init = true;
+}
+
+//******************************************************************************
+//  Calculate the encoding coefficients for a direction.
+//
+void ambi_encode(int order, t_ambi_norm norm, double azi, double ele,
+  double* coeffs) {
+
+  double leg[AMBI_TRI_CNT];
+  double cos_m[AMBI_ORDER_MAX + 1];
+  double sin_m[AMBI_ORDER_MAX + 1];
+
+  if (!ambi_sn3d_init) { ambi_build_sn3d(); }
+
+  double x = sin(ele * DEG_TO_RAD);  // Legendre argument
+  double y = cos(ele * DEG_TO_RAD);  // sqrt(1 - x^2)
+  double c = cos(azi * DEG_TO_RAD);
+  double s = sin(azi * DEG_TO_RAD);
+
+  // Multiple angles by the Chebyshev recurrence
+  cos_m[0] = 1;
+  sin_m[0] = 0;
+  for (int m = 1; m <= order; m++) {
+    cos_m[m] = (m == 1) ? c : 2 * c * cos_m[m - 1] - cos_m[m - 2];
+    sin_m[m] = (m == 1) ? s : 2 * c * sin_m[m - 1] - sin_m[m - 2];
+  }
+
+  // Associated Legendre functions: diagonal, sub-diagonal, then upwards
+  leg[0] = 1;
+  for (int m = 1; m <= order; m++) {
+    leg[AMBI_TRI(m, m)] = (2 * m - 1) * y * leg[AMBI_TRI(m - 1, m - 1)];
+  }
+  for (int m = 0; m < order; m++) {
+    leg[AMBI_TRI(m + 1, m)] = (2 * m + 1) * x * leg[AMBI_TRI(m, m)];
+  }
+  for (int m = 0; m <= order; m++) {
+    for (int n = m + 2; n <= order; n++) {
+      leg[AMBI_TRI(n, m)] = ((2 * n - 1) * x * leg[AMBI_TRI(n - 1, m)]
+        - (n + m - 1) * leg[AMBI_TRI(n - 2, m)]) / (n - m);
+    }
+  }
+
+  // Combine in ACN order: index n^2 + n + m
+  for (int n = 0; n <= order; n++) {
+    double scale = (norm == AMBI_N3D) ? sqrt(2.0 * n + 1) : 1.0;
+    double* row = coeffs + n * n + n;
+    row[0] = scale * ambi_sn3d[AMBI_TRI(n, 0)] * leg[AMBI_TRI(n, 0)];
+    for (int m = 1; m <= n; m++) {
+      double p = scale * ambi_sn3d[AMBI_TRI(n, m)] * leg[AMBI_TRI(n, m)];
+      row[m] = p * cos_m[m];
+      row[-m] = p * sin_m[m];
+    }
+  }
+}
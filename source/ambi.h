@@ -0,0 +1,52 @@
+#ifndef YC_AMBI_H_
+#define YC_AMBI_H_
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "ext.h"
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+#define AMBI_ORDER_MAX 7
+
+// Number of coefficients for an order
+#define AMBI_CNT(order) (((order) + 1) * ((order) + 1))
+
+//==============================================================================
+//  Typedef
+//==============================================================================
+
+//******************************************************************************
+//  Normalizations: the order matches the enum of the 'norm' attribute.
+//
+typedef enum _ambi_norm {
+  AMBI_SN3D,    // Schmidt semi-normalized
+  AMBI_N3D      // fully normalized, SN3D * sqrt(2n + 1)
+} t_ambi_norm;
+
+//==============================================================================
+//  Function declarations
+//==============================================================================
+
+//******************************************************************************
+//  Calculate the encoding coefficients for a direction.
+//
+//  The coefficients are the real spherical harmonics in ACN order, without
+//  the Condon-Shortley phase. The associated Legendre functions and the
+//  multiple angle sines and cosines are calculated by recurrence, from one
+//  sin and cos of each angle.
+//
+//  @param order The ambisonic order, from 0 to AMBI_ORDER_MAX.
+//  @param norm The normalization.
+//  @param azi The azimuth in degrees, counter-clockwise.
+//  @param ele The elevation in degrees.
+//  @param coeffs The AMBI_CNT(order) coefficients to fill in.
+//
+void ambi_encode(int order, t_ambi_norm norm, double azi, double ele,
+  double* coeffs);
+
+#endif
@@ -0,0 +1,27 @@
+//==============================================================================
+//
+//  @file ceil~.c
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief A Max external to round signals up.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+//==============================================================================
+//  Operation
+//==============================================================================
+
+#define ROUND_NAME "ceil"
+#define ROUND_DESC "rounded up"
+#define ROUND_SCALAR(x, v) OP_CEIL(v)
+#define ROUND_VECTOR(x, v) OP_CEIL_VEC(v)
+
+//==============================================================================
+//  Shared engine
+//==============================================================================
+
+#include "rounding~.h"
@@ -0,0 +1,136 @@
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "dbap.h"
+#include "max_util.h"
+#include <math.h>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define DBAP_SSE2
+#endif
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+#define DBAP_DB_PER_DOUBLING 6.02059991327962390427  // 20 * log10(2)
+
+#define DBAP_MIN_DIST2 1e-12  // avoids dividing by 0 on a speaker
+
+//==============================================================================
+//  Function definitions
+//==============================================================================
+
+//******************************************************************************
+//  Set the speaker positions.
+//
+t_max_err dbap_set_speakers(t_dbap* dbap, int cnt, double* pos) {
+
+  int pad_cnt = (cnt + 1) & ~1;
+
+  // One block for the 5 arrays, each keeping the 16 bytes alignment
+  double* block = (double*)sysmem_newptr_aligned(
+    5 * pad_cnt * sizeof(double), CACHE_LINE);
+  if (!block) { return MAX_ERR_OUT_OF_MEM; }
+
+  dbap_clear(dbap);
+  dbap->spk_cnt = cnt;
+  dbap->pad_cnt = pad_cnt;
+  dbap->x = block;
+  dbap->y = block + pad_cnt;
+  dbap->z = block + 2 * pad_cnt;
+  dbap->w = block + 3 * pad_cnt;
+  dbap->g = block + 4 * pad_cnt;
+
+  for (int i = 0; i < pad_cnt; i++) {
+    dbap->x[i] = (i < cnt) ? pos[3 * i] : 0;
+    dbap->y[i] = (i < cnt) ? pos[3 * i + 1] : 0;
+    dbap->z[i] = (i < cnt) ? pos[3 * i + 2] : 0;
+    dbap->w[i] = (i < cnt) ? 1.0 : 0;
+    dbap->g[i] = 0;
+  }
+
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Free the speaker arrays.
+//
+void dbap_clear(t_dbap* dbap) {
+
+  // The arrays share the block pointed to by x
+  if (dbap->x) { sysmem_freeptr_aligned(dbap->x); }
+  dbap->x = dbap->y = dbap->z = dbap->w = dbap->g = NULL;
+  dbap->spk_cnt = 0;
+  dbap->pad_cnt = 0;
+}
+
+//******************************************************************************
+//  Calculate the gains for a source position.
+//
+void dbap_pan(t_dbap* dbap, double px, double py, double pz,
+  double rolloff, double blur) {
+
+  int cnt = dbap->pad_cnt;
+  double* g = dbap->g;
+  double a = rolloff / DBAP_DB_PER_DOUBLING;
+  double blur2 = blur * blur;
+  double sum = 0;
+  int i = 0;
+
+#ifdef DBAP_SSE2
+  // Distance pass: g = d^2, or 1 / d directly for the default 6 dB rolloff
+  __m128d vpx = _mm_set1_pd(px);
+  __m128d vpy = _mm_set1_pd(py);
+  __m128d vpz = _mm_set1_pd(pz);
+  __m128d vb2 = _mm_set1_pd(blur2 > DBAP_MIN_DIST2 ? blur2 : DBAP_MIN_DIST2);
+  __m128d one = _mm_set1_pd(1.0);
+  t_bool inv = (a == 1.0);
+
+  for (i = 0; i < cnt; i += 2) {
+    __m128d dx = _mm_sub_pd(_mm_load_pd(dbap->x + i), vpx);
+    __m128d dy = _mm_sub_pd(_mm_load_pd(dbap->y + i), vpy);
+    __m128d dz = _mm_sub_pd(_mm_load_pd(dbap->z + i), vpz);
+    __m128d d2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)),
+      _mm_add_pd(_mm_mul_pd(dz, dz), vb2));
+    _mm_store_pd(g + i, inv ? _mm_div_pd(one, _mm_sqrt_pd(d2)) : d2);
+  }
+  if (!inv) {
+    for (i = 0; i < cnt; i++) {
+      g[i] = pow(g[i], -0.5 * a);
+    }
+  }
+
+  // Normalization pass: sum of the weighted powers, then scale
+  __m128d vsum = _mm_setzero_pd();
+  for (i = 0; i < cnt; i += 2) {
+    __m128d wg = _mm_mul_pd(_mm_load_pd(dbap->w + i), _mm_load_pd(g + i));
+    vsum = _mm_add_pd(vsum, _mm_mul_pd(wg, wg));
+  }
+  vsum = _mm_add_sd(vsum, _mm_unpackhi_pd(vsum, vsum));
+  sum = _mm_cvtsd_f64(vsum);
+
+  __m128d vk = _mm_set1_pd(sum > 0 ? 1.0 / sqrt(sum) : 0);
+  for (i = 0; i < cnt; i += 2) {
+    _mm_store_pd(g + i, _mm_mul_pd(_mm_load_pd(g + i), vk));
+  }
+
+#else
+  if (blur2 < DBAP_MIN_DIST2) { blur2 = DBAP_MIN_DIST2; }
+
+  for (i = 0; i < cnt; i++) {
+    double dx = dbap->x[i] - px;
+    double dy = dbap->y[i] - py;
+    double dz = dbap->z[i] - pz;
+    g[i] = pow(dx * dx + dy * dy + dz * dz + blur2, -0.5 * a);
+    sum += (dbap->w[i] * g[i]) * (dbap->w[i] * g[i]);
+  }
+
+  double k = sum > 0 ? 1.0 / sqrt(sum) : 0;
+  for (i = 0; i < cnt; i++) {
+    g[i] *= k;
+  }
+#endif
+}
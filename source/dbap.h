@@ -0,0 +1,74 @@
+#ifndef YC_DBAP_H_
+#define YC_DBAP_H_
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "ext.h"
+
+//==============================================================================
+//  Typedef
+//==============================================================================
+
+//******************************************************************************
+//  A speaker layout for distance-based panning.
+//
+//  The coordinates, weights and gains are stored as separate arrays,
+//  aligned and padded to a multiple of 2 values for the vectorized loops.
+//  The padding speakers have a weight of 0.
+//
+typedef struct _dbap {
+
+  int spk_cnt;
+  int pad_cnt;    // spk_cnt rounded up to a multiple of 2
+  double* x;
+  double* y;
+  double* z;
+  double* w;      // speaker weights, from the adjustment gains
+  double* g;      // unweighted gains from the last call to dbap_pan()
+
+} t_dbap;
+
+//==============================================================================
+//  Function declarations
+//==============================================================================
+
+//******************************************************************************
+//  Set the speaker positions.
+//
+//  @param dbap The structure to initialize, zeroed the first time, and
+//    freed with dbap_clear().
+//  @param cnt The number of speakers.
+//  @param pos The speaker positions, 3 values each.
+//
+//  @return MAX_ERR_NONE, or MAX_ERR_OUT_OF_MEM.
+//
+t_max_err dbap_set_speakers(t_dbap* dbap, int cnt, double* pos);
+
+//******************************************************************************
+//  Free the speaker arrays.
+//
+//  @param dbap The structure to clear.
+//
+void dbap_clear(t_dbap* dbap);
+
+//******************************************************************************
+//  Calculate the gains for a source position.
+//
+//  The gain of each speaker is k / sqrt(d^2 + blur^2)^a, with a derived
+//  from the rolloff, and k chosen so that the weighted gains w * g have
+//  unit power. The weights are not applied to dbap->g: they are applied
+//  downstream with the adjustment gains.
+//
+//  @param dbap The speaker layout, with its weights set.
+//  @param px The source position.
+//  @param py The source position.
+//  @param pz The source position.
+//  @param rolloff The rolloff in dB per doubling of distance.
+//  @param blur The spatial blur, in the unit of the positions.
+//
+void dbap_pan(t_dbap* dbap, double px, double py, double pz,
+  double rolloff, double blur);
+
+#endif
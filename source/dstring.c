@@ -781,6 +781,28 @@ t_dstr dstr_cat_join_floats(
   return dest;
 }
 
+//******************************************************************************
+//  Concatenate a strided list of floats into a dstring.
+//
+//  @param dest The dstring to copy into.
+//  @param argc The number of floats to concatenate.
+//  @param floats A pointer to the first float.
+//  @param stride The distance between consecutive floats, in floats.
+//  @param sep A C string separator to add between the atoms.
+//
+//  @return The dstring.
+//
+t_dstr dstr_cat_join_floats_stride(t_dstr dest, long argc,
+  t_atom_float* floats, long stride, t_uint8 prec, char* sep) {
+
+  if (argc > 0) { dstr_cat_float(dest, floats[0], prec); }
+  for (long i = 1; i < argc; i++) {
+    dstr_cat_cstr(dest, sep);
+    dstr_cat_float(dest, floats[i * stride], prec);
+  }
+  return dest;
+}
+
 //******************************************************************************
 //  Concatenate a list of symbols into a dstring.
 //
@@ -384,6 +384,20 @@ t_dstr dstr_cat_join_longs(
 t_dstr dstr_cat_join_floats(
   t_dstr dest, long argc, t_atom_float* floats, t_uint8 prec, char* sep);
 
+//******************************************************************************
+//  Concatenate a strided list of floats into a dstring.
+//
+//  @param dest The dstring to copy into.
+//  @param argc The number of floats to concatenate.
+//  @param floats A pointer to the first float.
+//  @param stride The distance between consecutive floats, in floats.
+//  @param sep A C string separator to add between the atoms.
+//
+//  @return The dstring.
+//
+t_dstr dstr_cat_join_floats_stride(t_dstr dest, long argc,
+  t_atom_float* floats, long stride, t_uint8 prec, char* sep);
+
 //******************************************************************************
 //  Concatenate a list of symbols into a dstring.
 //
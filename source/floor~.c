@@ -0,0 +1,27 @@
+//==============================================================================
+//
+//  @file floor~.c
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief A Max external to round signals down.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+//==============================================================================
+//  Operation
+//==============================================================================
+
+#define ROUND_NAME "floor"
+#define ROUND_DESC "rounded down"
+#define ROUND_SCALAR(x, v) OP_FLOOR(v)
+#define ROUND_VECTOR(x, v) OP_FLOOR_VEC(v)
+
+//==============================================================================
+//  Shared engine
+//==============================================================================
+
+#include "rounding~.h"
@@ -0,0 +1,173 @@
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "gcache.h"
+
+//==============================================================================
+//  Function definitions
+//==============================================================================
+
+//******************************************************************************
+//  Hash a key to a bucket.
+//
+static inline int gcache_hash(t_gcache* cache, t_int64* key) {
+
+  t_uint64 hash = 0;
+  for (int i = 0; i < GCACHE_KEY_LEN; i++) {
+    hash = (hash ^ (t_uint64)key[i]) * 0x9E3779B97F4A7C15ULL;
+  }
+  return (int)(hash >> 32) & (cache->bucket_cnt - 1);
+}
+
+//******************************************************************************
+//  Test if an entry matches a key.
+//
+static inline t_bool gcache_match(t_gcache* cache, int entry, t_int64* key) {
+
+  t_int64* entry_key = cache->keys + entry * GCACHE_KEY_LEN;
+  for (int i = 0; i < GCACHE_KEY_LEN; i++) {
+    if (entry_key[i] != key[i]) { return false; }
+  }
+  return true;
+}
+
+//******************************************************************************
+//  Unlink an entry from the LRU list.
+//
+static inline void gcache_unlink(t_gcache* cache, int entry) {
+
+  int prev = cache->prev[entry];
+  int next = cache->next[entry];
+  if (prev >= 0) { cache->next[prev] = next; }
+  else { cache->head = next; }
+  if (next >= 0) { cache->prev[next] = prev; }
+  else { cache->tail = prev; }
+}
+
+//******************************************************************************
+//  Link an entry at the head of the LRU list.
+//
+static inline void gcache_push_front(t_gcache* cache, int entry) {
+
+  cache->prev[entry] = -1;
+  cache->next[entry] = cache->head;
+  if (cache->head >= 0) { cache->prev[cache->head] = entry; }
+  cache->head = entry;
+  if (cache->tail < 0) { cache->tail = entry; }
+}
+
+//******************************************************************************
+//  Set the capacity of the cache, emptying it.
+//
+t_max_err gcache_set_capacity(t_gcache* cache, int cap, int width) {
+
+  gcache_free(cache);
+  if (cap <= 0) { return MAX_ERR_NONE; }
+
+  int bucket_cnt = 1;
+  while (bucket_cnt < 2 * cap) { bucket_cnt <<= 1; }
+
+  char* block = sysmem_newptr(
+    cap * (GCACHE_KEY_LEN * sizeof(t_int64) + width * sizeof(double)
+      + 3 * sizeof(int))
+    + bucket_cnt * sizeof(int));
+  if (!block) { return MAX_ERR_OUT_OF_MEM; }
+
+  cache->cap = cap;
+  cache->width = width;
+  cache->bucket_cnt = bucket_cnt;
+  cache->keys = (t_int64*)block;
+  cache->gains = (double*)(cache->keys + cap * GCACHE_KEY_LEN);
+  cache->chain = (int*)(cache->gains + cap * width);
+  cache->prev = cache->chain + cap;
+  cache->next = cache->prev + cap;
+  cache->buckets = cache->next + cap;
+  gcache_clear(cache);
+
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Free the cache arrays and turn it off.
+//
+void gcache_free(t_gcache* cache) {
+
+  // All the arrays share the block pointed to by keys
+  if (cache->keys) { sysmem_freeptr(cache->keys); }
+  cache->keys = NULL;
+  cache->gains = NULL;
+  cache->buckets = cache->chain = cache->prev = cache->next = NULL;
+  cache->cap = 0;
+  cache->cnt = 0;
+}
+
+//******************************************************************************
+//  Remove all the entries, keeping the capacity and the counters.
+//
+void gcache_clear(t_gcache* cache) {
+
+  cache->cnt = 0;
+  cache->head = -1;
+  cache->tail = -1;
+  if (cache->cap == 0) { return; }
+  for (int i = 0; i < cache->bucket_cnt; i++) {
+    cache->buckets[i] = -1;
+  }
+}
+
+//******************************************************************************
+//  Look up a key, counting the hit or miss.
+//
+double* gcache_get(t_gcache* cache, t_int64* key) {
+
+  if (cache->cap == 0) { return NULL; }
+
+  int entry = cache->buckets[gcache_hash(cache, key)];
+  while ((entry >= 0) && !gcache_match(cache, entry, key)) {
+    entry = cache->chain[entry];
+  }
+  if (entry < 0) {
+    cache->misses++;
+    return NULL;
+  }
+
+  cache->hits++;
+  if (entry != cache->head) {
+    gcache_unlink(cache, entry);
+    gcache_push_front(cache, entry);
+  }
+  return cache->gains + entry * cache->width;
+}
+
+//******************************************************************************
+//  Add an entry for a key that is not in the cache.
+//
+double* gcache_put(t_gcache* cache, t_int64* key) {
+
+  int entry;
+
+  if (cache->cnt < cache->cap) {
+    entry = cache->cnt++;
+  }
+  else {
+    // Evict the least recently used entry, and remove it from its bucket
+    entry = cache->tail;
+    gcache_unlink(cache, entry);
+    int* link = cache->buckets
+      + gcache_hash(cache, cache->keys + entry * GCACHE_KEY_LEN);
+    while (*link != entry) { link = cache->chain + *link; }
+    *link = cache->chain[entry];
+  }
+
+  t_int64* entry_key = cache->keys + entry * GCACHE_KEY_LEN;
+  for (int i = 0; i < GCACHE_KEY_LEN; i++) {
+    entry_key[i] = key[i];
+  }
+  int bucket = gcache_hash(cache, key);
+  cache->chain[entry] = cache->buckets[bucket];
+  cache->buckets[bucket] = entry;
+  gcache_push_front(cache, entry);
+
+  return cache->gains + entry * cache->width;
+}
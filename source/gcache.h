@@ -0,0 +1,97 @@
+#ifndef YC_GCACHE_H_
+#define YC_GCACHE_H_
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "ext.h"
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+// Number of integer values in a key
+#define GCACHE_KEY_LEN 4
+
+//==============================================================================
+//  Typedef
+//==============================================================================
+
+//******************************************************************************
+//  A least recently used cache of gain vectors with integer keys.
+//
+//  The entries are found through a hash table with chaining, and ordered
+//  in a doubly linked list from the most to the least recently used. All
+//  the arrays are allocated in one block when the capacity is set.
+//
+typedef struct _gcache {
+
+  int cap;          // 0 when the cache is off
+  int width;        // number of gains per entry
+  int cnt;
+  int bucket_cnt;   // power of 2
+
+  t_int64* keys;    // GCACHE_KEY_LEN per entry
+  double* gains;    // width per entry
+  int* buckets;     // first entry of each bucket, or -1
+  int* chain;       // next entry in the same bucket, or -1
+  int* prev;        // LRU list: towards the most recent, or -1
+  int* next;        // LRU list: towards the least recent, or -1
+  int head;         // most recently used entry
+  int tail;         // least recently used entry
+
+  t_uint64 hits;
+  t_uint64 misses;
+
+} t_gcache;
+
+//==============================================================================
+//  Function declarations
+//==============================================================================
+
+//******************************************************************************
+//  Set the capacity of the cache, emptying it.
+//
+//  @param cache The cache, zeroed the first time, and freed with
+//    gcache_free().
+//  @param cap The maximum number of entries, 0 to turn the cache off.
+//  @param width The number of gains per entry.
+//
+//  @return MAX_ERR_NONE, or MAX_ERR_OUT_OF_MEM with the cache off.
+//
+t_max_err gcache_set_capacity(t_gcache* cache, int cap, int width);
+
+//******************************************************************************
+//  Free the cache arrays and turn it off.
+//
+void gcache_free(t_gcache* cache);
+
+//******************************************************************************
+//  Remove all the entries, keeping the capacity and the counters.
+//
+void gcache_clear(t_gcache* cache);
+
+//******************************************************************************
+//  Look up a key, counting the hit or miss.
+//
+//  @param cache The cache.
+//  @param key The GCACHE_KEY_LEN values of the key.
+//
+//  @return The gains of the entry, now the most recently used, or NULL.
+//
+double* gcache_get(t_gcache* cache, t_int64* key);
+
+//******************************************************************************
+//  Add an entry for a key that is not in the cache.
+//
+//  The least recently used entry is replaced when the cache is full.
+//
+//  @param cache The cache, with a capacity above 0.
+//  @param key The GCACHE_KEY_LEN values of the key.
+//
+//  @return The width gains of the entry, to fill in.
+//
+double* gcache_put(t_gcache* cache, t_int64* key);
+
+#endif
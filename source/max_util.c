@@ -51,3 +51,35 @@ void attr_set_methods(t_class* c, const char* attrname,
     attr_addfilterset_proc(class_attr_get(c, gensym(attrname)), filter);
   }
 }
+
+//******************************************************************************
+//  Allocate a block of memory aligned on a power of two boundary.
+//
+//  The pointer returned by sysmem_newptr() is stored just before the
+//  aligned block, to be retrieved by sysmem_freeptr_aligned().
+//
+//  @param size The size of the block in bytes.
+//  @param align The alignment in bytes, a power of two.
+//
+//  @return A pointer to the aligned block, or NULL on failure.
+//
+void* sysmem_newptr_aligned(long size, long align) {
+
+  char* base = sysmem_newptr(size + align - 1 + (long)sizeof(void*));
+  if (!base) { return NULL; }
+
+  t_ptr_uint addr = (t_ptr_uint)(base + sizeof(void*));
+  void** aligned = (void**)((addr + align - 1) & ~((t_ptr_uint)align - 1));
+  aligned[-1] = base;
+  return aligned;
+}
+
+//******************************************************************************
+//  Free a block of memory allocated with sysmem_newptr_aligned().
+//
+//  @param ptr The aligned pointer, or NULL.
+//
+void sysmem_freeptr_aligned(void* ptr) {
+
+  if (ptr) { sysmem_freeptr(((void**)ptr)[-1]); }
+}
@@ -16,6 +16,8 @@
 
 #define CLIP(x, low, high) ((x) < (low) ? (low) : ((x) > (high) ? (high) : (x)))
 
+#define CACHE_LINE 64
+
 
 //******************************************************************************
 //  Utility function to set the properties of an attribute.
@@ -46,4 +48,21 @@ void attr_set_propr(t_class* c, const char* attrname,
 void attr_set_methods(t_class* c, const char* attrname,
   method setter, method getter, method filter);
 
+//******************************************************************************
+//  Allocate a block of memory aligned on a power of two boundary.
+//
+//  @param size The size of the block in bytes.
+//  @param align The alignment in bytes, a power of two.
+//
+//  @return A pointer to the aligned block, or NULL on failure.
+//
+void* sysmem_newptr_aligned(long size, long align);
+
+//******************************************************************************
+//  Free a block of memory allocated with sysmem_newptr_aligned().
+//
+//  @param ptr The aligned pointer, or NULL.
+//
+void sysmem_freeptr_aligned(void* ptr);
+
 #endif
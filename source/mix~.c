@@ -18,10 +18,19 @@
 #include "ext.h"
 #include "ext_obex.h"
 #include "z_dsp.h"
+#include "ext_buffer.h"
 #include "args_util.h"
 #include "max_util.h"
 #include <math.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
 //==============================================================================
 //  Defines
 //==============================================================================
@@ -32,10 +41,82 @@
 #define RAMP_DEF 30
 #define CNTD_CONST (t_uint32)(-1)
 
+// Control event log
+#define LOG_SIZE_DEF 1024       // in kilobytes
+#define LOG_MAGIC "YMIXLOG2"
+
+// Timer used for the DSP statistics: cycle counter when available
+#if defined(_MSC_VER) || defined(__i386__) || defined(__x86_64__)
+#define STATS_CLOCK_UNIT "cycles"
+#else
+#define STATS_CLOCK_UNIT "ns"
+#endif
+
 //==============================================================================
-//  Structure declaration for the object
+//  Structure declarations
 //==============================================================================
 
+//******************************************************************************
+//  Per input gain state, interleaved for the perform loop.
+//
+typedef struct _mix_gain {
+
+  double gain;
+  double targ;
+  double adjust;
+  double eff;     // master * adjust * gain, valid when not ramping
+
+} t_mix_gain;
+
+//******************************************************************************
+//  Types of the control events in the log.
+//
+typedef enum _mix_ev_type {
+
+  MIX_EV_STATE,       // master, master_targ, cntd, ramp_samp, auto, gains
+  MIX_EV_LIST,        // master_targ, targ for each input
+  MIX_EV_PAN,         // master, pan
+  MIX_EV_MASTER,      // master
+  MIX_EV_ADJUST,      // adjust for each input
+  MIX_EV_ADJUST_ONE,  // index, adjust
+  MIX_EV_RAMP,        // ramp_samp
+  MIX_EV_AUTO         // auto_on, auto_pos, auto_rate
+
+} t_mix_ev_type;
+
+//******************************************************************************
+//  Header of a control event in the log, followed by cnt doubles.
+//
+//  Control messages take effect at the start of the next audio vector, so
+//  the block index alone is sample accurate and the offset is always 0.
+//  This only holds when they are sent from the audio thread, between two
+//  vectors, that is with the scheduler in audio interrupt: events sent
+//  from any other thread stop the recording.
+//
+typedef struct _mix_event {
+
+  t_uint32 block;   // vector index from the start of the recording
+  t_uint16 offset;  // sample offset within the vector
+  t_uint16 cnt;     // number of double values following the header
+  t_uint32 type;    // t_mix_ev_type
+  t_uint32 reserved;
+
+} t_mix_event;
+
+//******************************************************************************
+//  Header of a log file.
+//
+typedef struct _mix_log_header {
+
+  char magic[8];
+  t_uint32 chan_in_cnt;
+  t_uint32 size;    // size of the events in bytes
+
+} t_mix_log_header;
+
+//******************************************************************************
+//  Structure declaration for the object.
+//
 typedef struct _mix {
 
   t_pxobject obj;
@@ -45,11 +126,45 @@ typedef struct _mix {
 
   double  master;
   double  master_targ;
-  double* gains;
-  double* gains_targ;
-  double* gains_adjust;
+  t_mix_gain* gains;
 
   t_uint32 cntd;
+  t_bool eff_dirty;
+
+  // Gain automation read from a buffer~, one channel per input
+  t_buffer_ref* auto_buf;
+  t_symbol* auto_name;
+  t_bool auto_on;
+  int auto_cnt;
+  double auto_pos;
+  double auto_rate;
+  double samplerate;
+
+  // DSP statistics: written by the audio thread only
+  t_uint64 stat_blocks;
+  t_uint64 stat_blocks_ramp;
+  t_uint64 stat_blocks_const;
+  t_uint64 stat_blocks_silent;
+  t_uint64 stat_skipped;
+  t_uint64 stat_time;
+  t_uint64 stat_time_max;
+  t_bool stat_reset;
+
+  // Control event log, for recording and for deterministic replay
+  t_uint64 block_cnt;
+  t_systhread audio_thread;
+  char* log;
+  t_uint32 log_len;
+  t_uint32 log_size;
+  t_uint64 log_block0;
+  t_bool log_start;
+  t_bool log_on;
+  char* replay;
+  t_uint32 replay_len;
+  t_uint32 replay_pos;
+  t_uint64 replay_block0;
+  t_bool replay_start;
+  t_bool replay_on;
 
   // Attributes
   char a_verbose;
@@ -76,6 +191,8 @@ void mix_dsp64(t_mix* x, t_object* dsp64, t_int32* count,
   t_double samplerate, long maxvectorsize, long flags);
 void mix_perform64(t_mix* x, t_object* dsp64, t_double** ins, long numins,
   t_double** outs, long numouts, long sampleframes, long flags, void* param);
+void mix_process(t_mix* x, t_double** ins, t_double** outs,
+  long sampleframes);
 void mix_assist(t_mix* x, void* b, long msg, long arg, char* str);
 
 t_max_err mix_set_ramp(t_mix* x, t_object* attr, long argc, t_atom* argv);
@@ -92,6 +209,34 @@ void mix_master(t_mix* x, double master);
 void mix_adjust(t_mix* x, t_symbol* sym, long argc, t_atom* argv);
 void mix_adjust_one(t_mix* x, t_symbol* sym, long argc, t_atom* argv);
 void mix_report(t_mix* x);
+void mix_update_eff(t_mix* x);
+
+t_max_err mix_notify(t_mix* x, t_symbol* sym, t_symbol* msg,
+  void* sender, void* data);
+void mix_auto_buffer(t_mix* x, t_symbol* name);
+void mix_auto_start(t_mix* x, t_symbol* sym, long argc, t_atom* argv);
+void mix_auto_stop(t_mix* x);
+void mix_auto_pos(t_mix* x, double pos);
+void mix_auto_rate(t_mix* x, double rate);
+
+void mix_stats(t_mix* x);
+void mix_stats_reset(t_mix* x);
+
+void mix_do_pan(t_mix* x, double master, double pan);
+void mix_log_event(t_mix* x, t_mix_ev_type type, int cnt, double* vals);
+void mix_log_gains(t_mix* x, t_mix_ev_type type);
+void mix_log_state(t_mix* x);
+void mix_log_auto(t_mix* x);
+void mix_replay_events(t_mix* x);
+void mix_record(t_mix* x, t_symbol* sym, long argc, t_atom* argv);
+void mix_record_stop(t_mix* x);
+void mix_record_write(t_mix* x, t_symbol* sym);
+void mix_do_record_write(t_mix* x, t_symbol* sym, long argc, t_atom* argv);
+void mix_replay_read(t_mix* x, t_symbol* sym);
+void mix_do_replay_read(t_mix* x, t_symbol* sym, long argc, t_atom* argv);
+t_bool mix_replay_validate(t_mix* x, char* events, t_uint32 size);
+void mix_replay(t_mix* x);
+void mix_replay_stop(t_mix* x);
 
 //==============================================================================
 //  Class definition and life cycle
@@ -129,6 +274,23 @@ void C74_EXPORT ext_main(void* r) {
   class_addmethod(c, (method)mix_adjust_one, "adjust_one", A_GIMME, 0);
   class_addmethod(c, (method)mix_report, "report", 0);
 
+  class_addmethod(c, (method)mix_notify, "notify", A_CANT, 0);
+  class_addmethod(c, (method)mix_auto_buffer, "auto_buffer", A_SYM, 0);
+  class_addmethod(c, (method)mix_auto_start, "auto_start", A_GIMME, 0);
+  class_addmethod(c, (method)mix_auto_stop, "auto_stop", 0);
+  class_addmethod(c, (method)mix_auto_pos, "auto_pos", A_FLOAT, 0);
+  class_addmethod(c, (method)mix_auto_rate, "auto_rate", A_FLOAT, 0);
+
+  class_addmethod(c, (method)mix_stats, "stats", 0);
+  class_addmethod(c, (method)mix_stats_reset, "stats_reset", 0);
+
+  class_addmethod(c, (method)mix_record, "record", A_GIMME, 0);
+  class_addmethod(c, (method)mix_record_stop, "record_stop", 0);
+  class_addmethod(c, (method)mix_record_write, "record_write", A_DEFSYM, 0);
+  class_addmethod(c, (method)mix_replay_read, "replay_read", A_DEFSYM, 0);
+  class_addmethod(c, (method)mix_replay, "replay", 0);
+  class_addmethod(c, (method)mix_replay_stop, "replay_stop", 0);
+
   // Attributes
   CLASS_ATTR_FLOAT(c, "ramp", 0, t_mix, a_ramp);
   attr_set_propr(c, "ramp", "1", NULL, NULL, "Ramp time in ms", "30");
@@ -174,14 +336,13 @@ void* mix_new(t_symbol* sym, long argc, t_atom* argv) {
   }
   x->obj.z_misc |= Z_NO_INPLACE;
 
-  // Allocate the dynamic arrays
-  x->gains = NULL;
-  x->gains_targ = NULL;
-  x->gains_adjust = NULL;
-  x->gains = (double*)sysmem_newptr(x->chan_in_cnt * sizeof(double));
-  x->gains_targ = (double*)sysmem_newptr(x->chan_in_cnt * sizeof(double));
-  x->gains_adjust = (double*)sysmem_newptr(x->chan_in_cnt * sizeof(double));
-  if ((!x->gains) || (!x->gains_targ) || (!x->gains_adjust)) {
+  // Allocate the per input gain state in one cache aligned block
+  x->auto_buf = NULL;
+  x->log = NULL;
+  x->replay = NULL;
+  x->gains = (t_mix_gain*)sysmem_newptr_aligned(
+    x->chan_in_cnt * sizeof(t_mix_gain), CACHE_LINE);
+  if (!x->gains) {
     mix_free(x);
     object_error((t_object*)x, "Allocation error");
     return NULL;
@@ -192,10 +353,31 @@ void* mix_new(t_symbol* sym, long argc, t_atom* argv) {
   x->master = 1.0;
   x->master_targ = 1.0;
   for (int i = 0; i < x->chan_in_cnt; i++) {
-    x->gains[i] = 0.0;
-    x->gains_targ[i] = 0.0;
-    x->gains_adjust[i] = 1.0;
+    x->gains[i].gain = 0.0;
+    x->gains[i].targ = 0.0;
+    x->gains[i].adjust = 1.0;
+    x->gains[i].eff = 0.0;
   }
+  x->eff_dirty = false;
+  x->auto_name = NULL;
+  x->auto_on = false;
+  x->auto_cnt = 0;
+  x->auto_pos = 0.0;
+  x->auto_rate = 1.0;
+  x->samplerate = sys_getsr();
+  x->stat_reset = true;
+  x->block_cnt = 0;
+  x->audio_thread = NULL;
+  x->log_len = 0;
+  x->log_size = 0;
+  x->log_block0 = 0;
+  x->log_start = false;
+  x->log_on = false;
+  x->replay_len = 0;
+  x->replay_pos = 0;
+  x->replay_block0 = 0;
+  x->replay_start = false;
+  x->replay_on = false;
   object_attr_setfloat(x, gensym("ramp"), RAMP_DEF);
 
   return x;
@@ -207,12 +389,14 @@ void* mix_new(t_symbol* sym, long argc, t_atom* argv) {
 void mix_free(t_mix* x) {
 
   dsp_free((t_pxobject*)x);
-  if (x->gains) { sysmem_freeptr(x->gains); }
-  if (x->gains_targ) { sysmem_freeptr(x->gains_targ); }
-  if (x->gains_adjust) { sysmem_freeptr(x->gains_adjust); }
+  if (x->auto_buf) { object_free(x->auto_buf); }
+  x->auto_buf = NULL;
+  sysmem_freeptr_aligned(x->gains);
   x->gains = NULL;
-  x->gains_targ = NULL;
-  x->gains_adjust = NULL;
+  if (x->log) { sysmem_freeptr(x->log); }
+  if (x->replay) { sysmem_freeptr(x->replay); }
+  x->log = NULL;
+  x->replay = NULL;
 }
 
 //******************************************************************************
@@ -222,6 +406,7 @@ void mix_dsp64(t_mix* x, t_object* dsp64, t_int32* count,
   t_double samplerate, long maxvectorsize, long flags) {
 
   object_method(dsp64, gensym("dsp_add64"), x, mix_perform64, 0, NULL);
+  x->samplerate = samplerate;
   x->ramp_samp = (t_uint32)(x->a_ramp * samplerate / 1000);
 }
 
@@ -362,6 +547,61 @@ t_double mix_add_ramp_2ch(
   return gain_end;
 }
 
+//******************************************************************************
+//  Read a linearly interpolated automation value from a buffer~.
+//
+t_double mix_auto_read(float* samples, t_atom_long frames,
+  t_atom_long chans, t_atom_long chan, t_double pos) {
+
+  if (pos <= 0) { return samples[chan]; }
+  t_atom_long index = (t_atom_long)pos;
+  if (index >= frames - 1) { return samples[(frames - 1) * chans + chan]; }
+  t_double frac = pos - index;
+  t_double val0 = samples[index * chans + chan];
+  t_double val1 = samples[(index + 1) * chans + chan];
+  return val0 + frac * (val1 - val0);
+}
+
+//******************************************************************************
+//  Add a mono audio channel, with an automated gain and a ramped master.
+//
+//  The automation is read at every sample, from pos0 in steps of dpos
+//  frames, so curves finer than the audio vector are followed.
+//
+void mix_add_auto_1ch(
+  t_double** outs, t_double** ins, t_uint32 di,
+  float* samples, t_atom_long frames, t_atom_long chans, t_atom_long chan,
+  t_double pos0, t_double dpos, t_double adjust,
+  t_double master0, t_double dmaster, t_uint32 ramp_len, t_uint32 end) {
+
+  t_double gain;
+  t_double master_end = master0 + ramp_len * dmaster;
+  for (t_uint32 s = 0; s < end; s++) {
+    gain = mix_auto_read(samples, frames, chans, chan, pos0 + s * dpos);
+    gain *= adjust * ((s < ramp_len) ? master0 + s * dmaster : master_end);
+    outs[0][s] += gain * ins[0][s];
+  }
+}
+
+//******************************************************************************
+//  Add stereo audio channels, with an automated gain and a ramped master.
+//
+void mix_add_auto_2ch(
+  t_double** outs, t_double** ins, t_uint32 di,
+  float* samples, t_atom_long frames, t_atom_long chans, t_atom_long chan,
+  t_double pos0, t_double dpos, t_double adjust,
+  t_double master0, t_double dmaster, t_uint32 ramp_len, t_uint32 end) {
+
+  t_double gain;
+  t_double master_end = master0 + ramp_len * dmaster;
+  for (t_uint32 s = 0; s < end; s++) {
+    gain = mix_auto_read(samples, frames, chans, chan, pos0 + s * dpos);
+    gain *= adjust * ((s < ramp_len) ? master0 + s * dmaster : master_end);
+    outs[0][s] += gain * ins[0][s];
+    outs[1][s] += gain * ins[di][s];
+  }
+}
+
 typedef t_double(*t_mix_mult)(
   t_double** outs, t_double gain0, t_double dgain,
   t_uint32 begin, t_uint32 end);
@@ -378,35 +618,145 @@ typedef t_double(*t_mix_add_ramp)(
 
 t_mix_mult mix_mult[2] = { mix_mult_1ch, mix_mult_2ch };
 t_mix_add_const mix_add_const[2] = { mix_add_const_1ch, mix_add_const_2ch };
+typedef void(*t_mix_add_auto)(
+  t_double** outs, t_double** ins, t_uint32 di,
+  float* samples, t_atom_long frames, t_atom_long chans, t_atom_long chan,
+  t_double pos0, t_double dpos, t_double adjust,
+  t_double master0, t_double dmaster, t_uint32 ramp_len, t_uint32 end);
+
 t_mix_add_ramp mix_add_ramp[2] = { mix_add_ramp_1ch, mix_add_ramp_2ch };
+t_mix_add_auto mix_add_auto[2] = { mix_add_auto_1ch, mix_add_auto_2ch };
 
 //******************************************************************************
-//  Audio function for stereo mode.
+//  Read the timer used for the DSP statistics.
+//
+static inline t_uint64 mix_stats_clock(void) {
+
+#if defined(_MSC_VER) || defined(__i386__) || defined(__x86_64__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (t_uint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+//******************************************************************************
+//  Audio function: time the processing and update the DSP statistics.
 //
 void mix_perform64(t_mix* x, t_object* dsp64, t_double** ins, long numins,
   t_double** outs, long numouts, long sampleframes, long flags, void* param) {
 
+  if (x->stat_reset) {
+    x->stat_blocks = 0;
+    x->stat_blocks_ramp = 0;
+    x->stat_blocks_const = 0;
+    x->stat_blocks_silent = 0;
+    x->stat_skipped = 0;
+    x->stat_time = 0;
+    x->stat_time_max = 0;
+    x->stat_reset = false;
+  }
+
+  t_uint64 time = mix_stats_clock();
+
+  // Events are only logged from this thread, stamped with block_cnt
+  x->audio_thread = systhread_self();
+  if (x->log_start) { mix_log_state(x); }
+  if (x->replay_on) { mix_replay_events(x); }
+
+  if ((x->master == 0) && (x->master_targ == 0)) {
+    x->stat_blocks_silent++;
+  }
+  else if (x->cntd == CNTD_CONST) {
+    x->stat_blocks_const++;
+  }
+  else {
+    x->stat_blocks_ramp++;
+  }
+  mix_process(x, ins, outs, sampleframes);
+
+  x->block_cnt++;
+
+  time = mix_stats_clock() - time;
+  x->stat_blocks++;
+  x->stat_time += time;
+  if (time > x->stat_time_max) { x->stat_time_max = time; }
+}
+
+//******************************************************************************
+//  Mix the input channels into the output channels.
+//
+void mix_process(t_mix* x, t_double** ins, t_double** outs,
+  long sampleframes) {
+
   // Initialize output to 0.0
   for (int ch = 0; ch < x->chan_out_cnt; ch++) {
     memset(outs[ch], 0, sizeof(t_double) * sampleframes);
   }
-  if ((x->master == 0) && (x->master_targ == 0)) { return; }
 
+  // Lock the automation buffer: its channels drive the first inputs
+  t_buffer_obj* auto_obj = NULL;
+  float* auto_samples = NULL;
+  t_atom_long auto_frames = 0;
+  t_atom_long auto_chans = 0;
+  int auto_cnt = 0;
+  t_double auto_pos0 = 0;
+  t_double auto_pos1 = 0;
+
+  if (x->auto_on && x->auto_buf
+    && (auto_obj = buffer_ref_getobject(x->auto_buf))
+    && (auto_samples = buffer_locksamples(auto_obj))) {
+
+    auto_frames = buffer_getframecount(auto_obj);
+    auto_chans = buffer_getchannelcount(auto_obj);
+    auto_cnt = (int)MIN(auto_chans, x->chan_in_cnt);
+    if (auto_frames == 0) { auto_cnt = 0; }
+
+    // Positions at the start and end of the vector, in frames
+    t_double frames_per_ms = buffer_getsamplerate(auto_obj) / 1000;
+    t_double dpos = x->auto_rate * sampleframes * 1000 / x->samplerate;
+    auto_pos0 = x->auto_pos * frames_per_ms;
+    auto_pos1 = (x->auto_pos + dpos) * frames_per_ms;
+    x->auto_pos += dpos;
+  }
+
+  // Inputs released by the automation need their effective gains updated
+  if (auto_cnt < x->auto_cnt) { x->eff_dirty = true; }
+  x->auto_cnt = auto_cnt;
+
+  if ((x->master == 0) && (x->master_targ == 0)) {
+    for (int i = 0; i < auto_cnt; i++) {
+      x->gains[i].gain = mix_auto_read(
+        auto_samples, auto_frames, auto_chans, i, auto_pos1);
+      x->gains[i].targ = x->gains[i].gain;
+    }
+    if (auto_samples) { buffer_unlocksamples(auto_obj); }
+    return;
+  }
+
+  // Master gain state at the start of the vector, for the automated inputs
+  t_double master0 = x->master;
+  t_double dmaster = 0;
   t_uint32 ramp_len = 0;
+  if (x->cntd != CNTD_CONST) {
+    dmaster = (x->master_targ - x->master) / x->cntd;
+    ramp_len = (x->cntd > sampleframes) ? sampleframes : x->cntd;
+  }
+
   t_double dgain;
 
   switch (x->cntd) {
 
     // If the gains are being ramped
     default:
-      ramp_len = (x->cntd > sampleframes) ? sampleframes : x->cntd;
 
       // Add the adjusted and ramped input channels
-      for (int i = 0; i < x->chan_in_cnt; i++) {
-        dgain = (x->gains_targ[i] - x->gains[i]) / x->cntd;
-        x->gains[i] = mix_add_ramp[x->chan_out_cnt - 1](
+      for (int i = auto_cnt; i < x->chan_in_cnt; i++) {
+        dgain = (x->gains[i].targ - x->gains[i].gain) / x->cntd;
+        x->gains[i].gain = mix_add_ramp[x->chan_out_cnt - 1](
           outs, ins + i, x->chan_in_cnt,
-          x->gains[i], dgain, x->gains_adjust[i], 0, ramp_len);
+          x->gains[i].gain, dgain, x->gains[i].adjust, 0, ramp_len);
       }
 
       // Multiply by the ramped master gain
@@ -417,26 +767,46 @@ void mix_perform64(t_mix* x, t_object* dsp64, t_double** ins, long numins,
       // Exit if the whole audio vector has been processed
       if (ramp_len == sampleframes) {
         x->cntd -= sampleframes;
-        return;
+        break;
       }
 
       // Process the potential end of the countdown
       x->cntd = CNTD_CONST;
       x->master = x->master_targ;
-      for (int i = 0; i < x->chan_in_cnt; i++) {
-        x->gains[i] = x->gains_targ[i];
+      for (int i = auto_cnt; i < x->chan_in_cnt; i++) {
+        x->gains[i].gain = x->gains[i].targ;
       }
+      x->eff_dirty = true;
       outlet_bang(x->outlet_mess);
       // fallthrough
 
     // If the gains are constant
     case CNTD_CONST:
-      for (int i = 0; i < x->chan_in_cnt; i++) {
-        dgain = x->master * x->gains_adjust[i] * x->gains[i];
+      if (x->eff_dirty) { mix_update_eff(x); }
+      for (int i = auto_cnt; i < x->chan_in_cnt; i++) {
+        x->stat_skipped += (x->gains[i].eff == 0);
         mix_add_const[x->chan_out_cnt - 1](
-          outs, ins + i, x->chan_in_cnt, dgain, ramp_len, sampleframes);
+          outs, ins + i, x->chan_in_cnt, x->gains[i].eff,
+          ramp_len, sampleframes);
       }
-      return;
+      break;
+  }
+
+  // Add the automated inputs, reading the automation at every sample
+  if (auto_samples) {
+    t_double gain1;
+    for (int i = 0; i < auto_cnt; i++) {
+      mix_add_auto[x->chan_out_cnt - 1](
+        outs, ins + i, x->chan_in_cnt,
+        auto_samples, auto_frames, auto_chans, i,
+        auto_pos0, (auto_pos1 - auto_pos0) / sampleframes,
+        x->gains[i].adjust, master0, dmaster, ramp_len, sampleframes);
+      gain1 = mix_auto_read(
+        auto_samples, auto_frames, auto_chans, i, auto_pos1);
+      x->gains[i].gain = gain1;
+      x->gains[i].targ = gain1;
+    }
+    buffer_unlocksamples(auto_obj);
   }
 }
 
@@ -470,6 +840,8 @@ void mix_assist(t_mix* x, void* b, long msg, long arg, char* str) {
 //
 t_max_err mix_set_ramp(t_mix* x, t_object* attr, long argc, t_atom* argv) {
 
+  if (x->replay_on) { return MAX_ERR_NONE; }
+
   if (args_count_is(x, gensym("attr ramp"), argc, 1)
     && args_is_number(x, gensym("attr ramp"), argv, 0, is_above_f, 1, 0)) {
     x->a_ramp = (float)atom_getfloat(argv);
@@ -478,6 +850,10 @@ t_max_err mix_set_ramp(t_mix* x, t_object* attr, long argc, t_atom* argv) {
     x->a_ramp = (float)RAMP_DEF;
   }
   x->ramp_samp = (t_uint32)(x->a_ramp * sys_getsr() / 1000);
+  if (x->log_on) {
+    double val = x->ramp_samp;
+    mix_log_event(x, MIX_EV_RAMP, 1, &val);
+  }
   return MAX_ERR_NONE;
 }
 
@@ -507,14 +883,16 @@ void mix_float(t_mix* x, double val) {
 //
 void mix_list(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
 
+  if (x->replay_on) { return; }
   x->master_targ = atom_getfloat(argv);
   for (int i = 0; i < MIN(argc - 1, x->chan_in_cnt); i++) {
-    x->gains_targ[i] = atom_getfloat(argv + i + 1);
+    x->gains[i].targ = atom_getfloat(argv + i + 1);
   }
   for (int i = argc - 1; i < x->chan_in_cnt; i++) {
-    x->gains_targ[i] = 0;
+    x->gains[i].targ = 0;
   }
   x->cntd = x->ramp_samp;
+  if (x->log_on) { mix_log_gains(x, MIX_EV_LIST); }
 }
 
 //******************************************************************************
@@ -529,8 +907,10 @@ void mix_anything(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
 //
 void mix_master(t_mix* x, double master) {
 
+  if (x->replay_on) { return; }
   x->master_targ = master;
   x->cntd = x->ramp_samp;
+  if (x->log_on) { mix_log_event(x, MIX_EV_MASTER, 1, &master); }
 }
 
 //******************************************************************************
@@ -538,25 +918,38 @@ void mix_master(t_mix* x, double master) {
 //
 void mix_pan(t_mix* x, double master, double pan) {
 
+  if (x->replay_on) { return; }
+  mix_do_pan(x, master, pan);
+  if (x->log_on) {
+    double vals[2] = { master, pan };
+    mix_log_event(x, MIX_EV_PAN, 2, vals);
+  }
+}
+
+//******************************************************************************
+//  Calculate the target gains to pan between the input channels.
+//
+void mix_do_pan(t_mix* x, double master, double pan) {
+
   x->master_targ = master;
 
   // Initialize to 0
   for (int i = 0; i < x->chan_in_cnt; i++) {
-    x->gains_targ[i] = 0;
+    x->gains[i].targ = 0;
   }
 
   // Calculate the pan values
   if (pan <= 0) {
-    x->gains_targ[0] = 1;
+    x->gains[0].targ = 1;
   }
   else if (pan >= x->chan_in_cnt - 1) {
-    x->gains_targ[x->chan_in_cnt - 1] = 1;
+    x->gains[x->chan_in_cnt - 1].targ = 1;
   }
   else {
     int index = (int)pan;
     double r = cos((pan - index) * M_PI_2);
-    x->gains_targ[index] = r;
-    x->gains_targ[index + 1] = sqrt(1 - r * r);
+    x->gains[index].targ = r;
+    x->gains[index + 1].targ = sqrt(1 - r * r);
   }
   x->cntd = x->ramp_samp;
 }
@@ -566,6 +959,7 @@ void mix_pan(t_mix* x, double master, double pan) {
 //
 void mix_adjust(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
 
+  if (x->replay_on) { return; }
   t_symbol* symbols[2] = { gensym("ampl"), gensym("db") };
   if (args_count_is(x, sym, argc, x->chan_in_cnt + 1)
     && args_is_sym(x, sym, argv, 0, 2, symbols)) {
@@ -573,15 +967,18 @@ void mix_adjust(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
     if (atom_getsym(argv) == gensym("ampl")
       && args_are_numbers(x, sym, argv, 1, x->chan_in_cnt, is_above_f, 0, 0)) {
       for (int i = 0; i < x->chan_in_cnt; i++) {
-        x->gains_adjust[i] = atom_getfloat(argv + i + 1);
+        x->gains[i].adjust = atom_getfloat(argv + i + 1);
       }
+      mix_update_eff(x);
     }
     else if (atom_getsym(argv) == gensym("db")
       && args_are_numbers(x, sym, argv, 1, x->chan_in_cnt, NULL, 0, 0)) {
       for (int i = 0; i < x->chan_in_cnt; i++) {
-        x->gains_adjust[i] = exp(atom_getfloat(argv + i + 1) * M_LN10_20);
+        x->gains[i].adjust = exp(atom_getfloat(argv + i + 1) * M_LN10_20);
       }
+      mix_update_eff(x);
     }
+    if (x->log_on) { mix_log_gains(x, MIX_EV_ADJUST); }
   }
 }
 
@@ -590,24 +987,41 @@ void mix_adjust(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
 //
 void mix_adjust_one(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
 
+  if (x->replay_on) { return; }
   t_symbol* symbols[2] = { gensym("ampl"), gensym("db") };
   if (args_count_is(x, sym, argc, 3)
     && args_is_sym(x, sym, argv, 0, 2, symbols)
     && args_is_long(x, sym, argv, 1, is_between_l, 0, x->chan_in_cnt - 1)) {
 
+    t_mix_gain* gain = x->gains + atom_getlong(argv + 1);
     if ((atom_getsym(argv) == gensym("ampl"))
       && args_is_number(x, sym, argv, 2, is_above_f, 0, 0)) {
-      x->gains_adjust[atom_getlong(argv + 1)] =
-        atom_getfloat(argv + 2);
+      gain->adjust = atom_getfloat(argv + 2);
+      gain->eff = x->master * gain->adjust * gain->gain;
     }
     else if ((atom_getsym(argv) == gensym("db"))
       && args_is_number(x, sym, argv, 2, NULL, 0, 0)) {
-      x->gains_adjust[atom_getlong(argv + 1)] =
-        exp(atom_getfloat(argv + 2) * M_LN10_20);
+      gain->adjust = exp(atom_getfloat(argv + 2) * M_LN10_20);
+      gain->eff = x->master * gain->adjust * gain->gain;
+    }
+    if (x->log_on) {
+      double vals[2] = { (double)atom_getlong(argv + 1), gain->adjust };
+      mix_log_event(x, MIX_EV_ADJUST_ONE, 2, vals);
     }
   }
 }
 
+//******************************************************************************
+//  Update the effective gains used while the gains are constant.
+//
+void mix_update_eff(t_mix* x) {
+
+  for (int i = 0; i < x->chan_in_cnt; i++) {
+    x->gains[i].eff = x->master * x->gains[i].adjust * x->gains[i].gain;
+  }
+  x->eff_dirty = false;
+}
+
 //******************************************************************************
 //  Post the structure values in the console.
 //
@@ -620,15 +1034,542 @@ void mix_report(t_mix* x) {
   POST("%s", dstr->cstr);
   dstr_clear(dstr);
   dstr_cat_cstr(dstr, "    Current gains: ");
-  dstr_cat_join_floats(dstr, x->chan_in_cnt, x->gains, 4, ", ");
+  dstr_cat_join_floats_stride(dstr, x->chan_in_cnt, &x->gains[0].gain,
+    sizeof(t_mix_gain) / sizeof(double), 4, ", ");
   POST("%s", dstr->cstr);
   dstr_clear(dstr);
   dstr_cat_cstr(dstr, "    Target gains: ");
-  dstr_cat_join_floats(dstr, x->chan_in_cnt, x->gains_targ, 4, ", ");
+  dstr_cat_join_floats_stride(dstr, x->chan_in_cnt, &x->gains[0].targ,
+    sizeof(t_mix_gain) / sizeof(double), 4, ", ");
   POST("%s", dstr->cstr);
   dstr_clear(dstr);
   dstr_cat_cstr(dstr, "    Adjust gains:    ");
-  dstr_cat_join_floats(dstr, x->chan_in_cnt, x->gains_adjust, 4, ", ");
+  dstr_cat_join_floats_stride(dstr, x->chan_in_cnt, &x->gains[0].adjust,
+    sizeof(t_mix_gain) / sizeof(double), 4, ", ");
   POST("%s", dstr->cstr);
+  if (x->auto_name) {
+    dstr_clear(dstr);
+    dstr_cat_printf(dstr, "    Automation: %s - %s - "
+      "Position (ms): %.1f - Rate: %.3f",
+      x->auto_name->s_name, x->auto_on ? "playing" : "stopped",
+      x->auto_pos, x->auto_rate);
+    POST("%s", dstr->cstr);
+  }
   dstr_free(&dstr);
 }
+
+//******************************************************************************
+//  Forward buffer~ notifications to the automation buffer reference.
+//
+t_max_err mix_notify(t_mix* x, t_symbol* sym, t_symbol* msg,
+  void* sender, void* data) {
+
+  if (x->auto_buf) {
+    return buffer_ref_notify(x->auto_buf, sym, msg, sender, data);
+  }
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Set the buffer~ holding the gain automation, one channel per input.
+//
+void mix_auto_buffer(t_mix* x, t_symbol* name) {
+
+  if (x->replay_on) { return; }
+  if (!x->auto_buf) {
+    x->auto_buf = buffer_ref_new((t_object*)x, name);
+  }
+  else {
+    buffer_ref_set(x->auto_buf, name);
+  }
+  x->auto_name = name;
+}
+
+//******************************************************************************
+//  Start playing the automation, optionally from a position in ms.
+//
+void mix_auto_start(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  if (x->replay_on) { return; }
+  if (!x->auto_buf) {
+    if (x->a_verbose) { WARN("auto_start: No automation buffer set."); }
+    return;
+  }
+  if (args_count_is_between(x, sym, argc, 0, 1)) {
+    if ((argc == 1) && args_is_number(x, sym, argv, 0, is_above_f, 0, 0)) {
+      x->auto_pos = atom_getfloat(argv);
+    }
+    x->auto_on = true;
+    if (x->log_on) { mix_log_auto(x); }
+  }
+}
+
+//******************************************************************************
+//  Stop playing the automation, holding the current gains.
+//
+void mix_auto_stop(t_mix* x) {
+
+  if (x->replay_on) { return; }
+  x->auto_on = false;
+  if (x->log_on) { mix_log_auto(x); }
+}
+
+//******************************************************************************
+//  Set the automation playback position in ms.
+//
+void mix_auto_pos(t_mix* x, double pos) {
+
+  if (x->replay_on) { return; }
+  x->auto_pos = (pos < 0) ? 0 : pos;
+  if (x->log_on) { mix_log_auto(x); }
+}
+
+//******************************************************************************
+//  Set the automation playback rate, relative to the buffer~ sample rate.
+//
+void mix_auto_rate(t_mix* x, double rate) {
+
+  if (x->replay_on) { return; }
+  x->auto_rate = (rate < 0) ? 0 : rate;
+  if (x->log_on) { mix_log_auto(x); }
+}
+
+
+//******************************************************************************
+//  Output the DSP statistics as a list of labels and values.
+//
+//  The counters are written by the audio thread only and are read here
+//  without locking: a value may lag by one vector.
+//
+void mix_stats(t_mix* x) {
+
+  t_uint64 blocks = x->stat_blocks;
+  t_atom atoms[16];
+
+  atom_setsym(atoms, gensym("blocks"));
+  atom_setlong(atoms + 1, (t_atom_long)blocks);
+  atom_setsym(atoms + 2, gensym("ramp"));
+  atom_setlong(atoms + 3, (t_atom_long)x->stat_blocks_ramp);
+  atom_setsym(atoms + 4, gensym("const"));
+  atom_setlong(atoms + 5, (t_atom_long)x->stat_blocks_const);
+  atom_setsym(atoms + 6, gensym("silent"));
+  atom_setlong(atoms + 7, (t_atom_long)x->stat_blocks_silent);
+  atom_setsym(atoms + 8, gensym("skipped"));
+  atom_setlong(atoms + 9, (t_atom_long)x->stat_skipped);
+  atom_setsym(atoms + 10, gensym("unit"));
+  atom_setsym(atoms + 11, gensym(STATS_CLOCK_UNIT));
+  atom_setsym(atoms + 12, gensym("mean"));
+  atom_setfloat(atoms + 13, blocks ? (double)x->stat_time / blocks : 0);
+  atom_setsym(atoms + 14, gensym("max"));
+  atom_setlong(atoms + 15, (t_atom_long)x->stat_time_max);
+  outlet_anything(x->outlet_mess, gensym("stats"), 16, atoms);
+}
+
+//******************************************************************************
+//  Reset the DSP statistics, at the start of the next audio vector.
+//
+void mix_stats_reset(t_mix* x) {
+
+  x->stat_reset = true;
+}
+
+//******************************************************************************
+//  Append a control event to the log, stamped with the next audio vector.
+//
+//  The log does not wrap around: overwriting the oldest events would lose
+//  the initial state and break the replay, so recording stops when full.
+//  Events from another thread than the audio thread cannot be stamped
+//  with a vector, and also stop the recording.
+//
+void mix_log_event(t_mix* x, t_mix_ev_type type, int cnt, double* vals) {
+
+  if (systhread_self() != x->audio_thread) {
+    x->log_on = false;
+    object_error((t_object*)x, "record: Control messages must come from "
+      "the audio thread, with the scheduler in audio interrupt. "
+      "Recording stopped.");
+    return;
+  }
+
+  t_uint32 len = sizeof(t_mix_event) + cnt * sizeof(double);
+  if (x->log_len + len > x->log_size) {
+    x->log_on = false;
+    if (x->a_verbose) { WARN("record: Log full, recording stopped."); }
+    return;
+  }
+
+  t_mix_event* ev = (t_mix_event*)(x->log + x->log_len);
+  ev->block = (t_uint32)(x->block_cnt - x->log_block0);
+  ev->offset = 0;
+  ev->cnt = (t_uint16)cnt;
+  ev->type = type;
+  ev->reserved = 0;
+  memcpy(ev + 1, vals, cnt * sizeof(double));
+  x->log_len += len;
+}
+
+//******************************************************************************
+//  Append the master target and target gains, or the adjust gains.
+//
+void mix_log_gains(t_mix* x, t_mix_ev_type type) {
+
+  double vals[0x100];
+  int cnt = 0;
+
+  if (type == MIX_EV_LIST) {
+    vals[cnt++] = x->master_targ;
+    for (int i = 0; i < x->chan_in_cnt; i++) {
+      vals[cnt++] = x->gains[i].targ;
+    }
+  }
+  else {
+    for (int i = 0; i < x->chan_in_cnt; i++) {
+      vals[cnt++] = x->gains[i].adjust;
+    }
+  }
+  mix_log_event(x, type, cnt, vals);
+}
+
+//******************************************************************************
+//  Start the log with the complete state, so that the replay is identical.
+//
+//  Called from the audio thread, before the vector is processed.
+//
+void mix_log_state(t_mix* x) {
+
+  double vals[7 + 3 * 0xFF];
+  int cnt = 0;
+  vals[cnt++] = x->master;
+  vals[cnt++] = x->master_targ;
+  vals[cnt++] = x->cntd;
+  vals[cnt++] = x->ramp_samp;
+  vals[cnt++] = x->auto_on;
+  vals[cnt++] = x->auto_pos;
+  vals[cnt++] = x->auto_rate;
+  for (int i = 0; i < x->chan_in_cnt; i++) {
+    vals[cnt++] = x->gains[i].gain;
+    vals[cnt++] = x->gains[i].targ;
+    vals[cnt++] = x->gains[i].adjust;
+  }
+  x->log_start = false;
+  x->log_len = 0;
+  x->log_block0 = x->block_cnt;
+  mix_log_event(x, MIX_EV_STATE, cnt, vals);
+  x->log_on = true;
+}
+
+//******************************************************************************
+//  Append the automation playback state.
+//
+void mix_log_auto(t_mix* x) {
+
+  double vals[3] = { (double)x->auto_on, x->auto_pos, x->auto_rate };
+  mix_log_event(x, MIX_EV_AUTO, 3, vals);
+}
+
+//******************************************************************************
+//  Apply the logged events due at the current audio vector.
+//
+//  Called from the audio thread, before the vector is processed.
+//
+void mix_replay_events(t_mix* x) {
+
+  if (x->replay_start) {
+    x->replay_block0 = x->block_cnt;
+    x->replay_pos = 0;
+    x->replay_start = false;
+  }
+
+  t_uint64 block = x->block_cnt - x->replay_block0;
+  t_mix_event* ev;
+  double* vals;
+
+  while (x->replay_pos < x->replay_len) {
+
+    ev = (t_mix_event*)(x->replay + x->replay_pos);
+    if (ev->block > block) { return; }
+    vals = (double*)(ev + 1);
+    x->replay_pos += sizeof(t_mix_event) + ev->cnt * sizeof(double);
+
+    switch (ev->type) {
+    case MIX_EV_STATE:
+      x->master = vals[0];
+      x->master_targ = vals[1];
+      x->cntd = (t_uint32)vals[2];
+      x->ramp_samp = (t_uint32)vals[3];
+      x->auto_on = vals[4] != 0;
+      x->auto_pos = vals[5];
+      x->auto_rate = vals[6];
+      for (int i = 0; i < x->chan_in_cnt; i++) {
+        x->gains[i].gain = vals[7 + 3 * i];
+        x->gains[i].targ = vals[8 + 3 * i];
+        x->gains[i].adjust = vals[9 + 3 * i];
+      }
+      x->eff_dirty = true;
+      break;
+    case MIX_EV_LIST:
+      x->master_targ = vals[0];
+      for (int i = 0; i < x->chan_in_cnt; i++) {
+        x->gains[i].targ = vals[i + 1];
+      }
+      x->cntd = x->ramp_samp;
+      break;
+    case MIX_EV_PAN:
+      mix_do_pan(x, vals[0], vals[1]);
+      break;
+    case MIX_EV_MASTER:
+      x->master_targ = vals[0];
+      x->cntd = x->ramp_samp;
+      break;
+    case MIX_EV_ADJUST:
+      for (int i = 0; i < x->chan_in_cnt; i++) {
+        x->gains[i].adjust = vals[i];
+      }
+      mix_update_eff(x);
+      break;
+    case MIX_EV_ADJUST_ONE:
+      x->gains[(int)vals[0]].adjust = vals[1];
+      x->gains[(int)vals[0]].eff = x->master * vals[1]
+        * x->gains[(int)vals[0]].gain;
+      break;
+    case MIX_EV_RAMP:
+      x->ramp_samp = (t_uint32)vals[0];
+      break;
+    case MIX_EV_AUTO:
+      x->auto_on = vals[0] != 0;
+      x->auto_pos = vals[1];
+      x->auto_rate = vals[2];
+      break;
+    }
+  }
+  x->replay_on = false;
+}
+
+//******************************************************************************
+//  Start recording the control events, with an optional log size in KB.
+//
+//  The recording starts at the next audio vector, with a snapshot of the
+//  state taken on the audio thread.
+//
+void mix_record(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  if (x->replay_on) {
+    if (x->a_verbose) { WARN("record: Stop the replay first."); }
+    return;
+  }
+  if (!args_count_is_between(x, sym, argc, 0, 1)) { return; }
+
+  t_atom_long size = LOG_SIZE_DEF;
+  if ((argc == 1) && args_is_long(x, sym, argv, 0, is_between_l, 1, 0x3FFFFF)) {
+    size = atom_getlong(argv);
+  }
+  size *= 1024;
+
+  x->log_on = false;
+  x->log_start = false;
+  if (x->log_size != size) {
+    if (x->log) { sysmem_freeptr(x->log); }
+    x->log = sysmem_newptr((long)size);
+    x->log_size = x->log ? (t_uint32)size : 0;
+  }
+  if (!x->log) {
+    object_error((t_object*)x, "record: Allocation error");
+    return;
+  }
+
+  x->log_len = 0;
+  x->log_start = true;
+}
+
+//******************************************************************************
+//  Stop recording the control events.
+//
+void mix_record_stop(t_mix* x) {
+
+  x->log_start = false;
+  x->log_on = false;
+}
+
+//******************************************************************************
+//  Write the recorded log to a file.
+//
+void mix_record_write(t_mix* x, t_symbol* sym) {
+
+  defer_low(x, (method)mix_do_record_write, sym, 0, NULL);
+}
+
+//******************************************************************************
+//  Write the recorded log to a file, deferred to the main thread.
+//
+void mix_do_record_write(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  char filename[MAX_FILENAME_CHARS];
+  short path;
+  t_fourcc type = FOUR_CHAR_CODE('DATA');
+  t_filehandle fh;
+
+  if (!x->log || (x->log_len == 0)) {
+    if (x->a_verbose) { WARN("record_write: Nothing recorded."); }
+    return;
+  }
+  if (sym == gensym("")) {
+    strncpy_zero(filename, "mix_log.bin", MAX_FILENAME_CHARS);
+    if (saveasdialog_extended(filename, &path, &type, &type, 1)) { return; }
+  }
+  else {
+    strncpy_zero(filename, sym->s_name, MAX_FILENAME_CHARS);
+    path = path_getdefault();
+  }
+  if (path_createsysfile(filename, path, type, &fh)) {
+    object_error((t_object*)x, "record_write: Cannot create %s", filename);
+    return;
+  }
+
+  t_mix_log_header header;
+  memcpy(header.magic, LOG_MAGIC, 8);
+  header.chan_in_cnt = x->chan_in_cnt;
+  header.size = x->log_len;
+
+  t_ptr_size count = sizeof(header);
+  t_max_err err = sysfile_write(fh, &count, &header);
+  count = header.size;
+  if (!err) { err = sysfile_write(fh, &count, x->log); }
+  sysfile_seteof(fh, sizeof(header) + header.size);
+  sysfile_close(fh);
+  if (err) { object_error((t_object*)x, "record_write: Write error"); }
+}
+
+//******************************************************************************
+//  Read a log file for replay.
+//
+void mix_replay_read(t_mix* x, t_symbol* sym) {
+
+  defer_low(x, (method)mix_do_replay_read, sym, 0, NULL);
+}
+
+//******************************************************************************
+//  Read a log file for replay, deferred to the main thread.
+//
+void mix_do_replay_read(t_mix* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  char filename[MAX_FILENAME_CHARS];
+  short path;
+  t_fourcc type;
+  t_filehandle fh;
+
+  if (x->replay_on) {
+    if (x->a_verbose) { WARN("replay_read: Stop the replay first."); }
+    return;
+  }
+  if (sym == gensym("")) {
+    if (open_dialog(filename, &path, &type, NULL, 0)) { return; }
+  }
+  else {
+    strncpy_zero(filename, sym->s_name, MAX_FILENAME_CHARS);
+    if (locatefile_extended(filename, &path, &type, NULL, 0)) {
+      object_error((t_object*)x, "replay_read: Cannot find %s", filename);
+      return;
+    }
+  }
+  if (path_opensysfile(filename, path, &fh, READ_PERM)) {
+    object_error((t_object*)x, "replay_read: Cannot open %s", filename);
+    return;
+  }
+
+  t_mix_log_header header;
+  t_ptr_size count = sizeof(header);
+  if (sysfile_read(fh, &count, &header) || (count != sizeof(header))
+    || memcmp(header.magic, LOG_MAGIC, 8)
+    || (header.chan_in_cnt != x->chan_in_cnt)) {
+    sysfile_close(fh);
+    object_error((t_object*)x, "replay_read: Invalid log for %i inputs",
+      x->chan_in_cnt);
+    return;
+  }
+
+  if (x->replay) { sysmem_freeptr(x->replay); }
+  x->replay_len = 0;
+  x->replay = sysmem_newptr(header.size);
+  count = header.size;
+  if (!x->replay || sysfile_read(fh, &count, x->replay)
+    || (count != header.size)) {
+    object_error((t_object*)x, "replay_read: Read error");
+  }
+  else if (!mix_replay_validate(x, x->replay, header.size)) {
+    object_error((t_object*)x, "replay_read: Corrupt log");
+  }
+  else {
+    x->replay_len = header.size;
+  }
+  sysfile_close(fh);
+}
+
+//******************************************************************************
+//  Check all the events of a log before it is replayed.
+//
+//  The replay runs on the audio thread and trusts the events, so each one
+//  must fit in the log, have a known type, the value count of its type,
+//  and for MIX_EV_ADJUST_ONE an input index in range.
+//
+t_bool mix_replay_validate(t_mix* x, char* events, t_uint32 size) {
+
+  t_uint32 pos = 0;
+  t_mix_event* ev;
+  double* vals;
+  int cnt;
+
+  while (pos < size) {
+    if (size - pos < sizeof(t_mix_event)) { return false; }
+    ev = (t_mix_event*)(events + pos);
+    vals = (double*)(ev + 1);
+    pos += sizeof(t_mix_event);
+    if ((size - pos) / sizeof(double) < ev->cnt) { return false; }
+    pos += ev->cnt * sizeof(double);
+
+    switch (ev->type) {
+    case MIX_EV_STATE: cnt = 7 + 3 * x->chan_in_cnt; break;
+    case MIX_EV_LIST: cnt = x->chan_in_cnt + 1; break;
+    case MIX_EV_PAN: cnt = 2; break;
+    case MIX_EV_MASTER: cnt = 1; break;
+    case MIX_EV_ADJUST: cnt = x->chan_in_cnt; break;
+    case MIX_EV_ADJUST_ONE: cnt = 2; break;
+    case MIX_EV_RAMP: cnt = 1; break;
+    case MIX_EV_AUTO: cnt = 3; break;
+    default: return false;
+    }
+    if (ev->cnt != cnt) { return false; }
+
+    if ((ev->type == MIX_EV_ADJUST_ONE)
+      && !((vals[0] >= 0) && (vals[0] < x->chan_in_cnt))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//******************************************************************************
+//  Replay the log from the next audio vector, ignoring control messages.
+//
+//  The output is bit-identical to the recording for the same input audio,
+//  vector size and automation buffer~ content. The automation playback
+//  state is in the log, and the auto_* messages are ignored as well.
+//
+void mix_replay(t_mix* x) {
+
+  if (!x->replay || (x->replay_len == 0)) {
+    if (x->a_verbose) { WARN("replay: No log read."); }
+    return;
+  }
+  x->log_start = false;
+  x->log_on = false;
+  x->replay_start = true;
+  x->replay_on = true;
+}
+
+//******************************************************************************
+//  Stop the replay.
+//
+void mix_replay_stop(t_mix* x) {
+
+  x->replay_on = false;
+}
\ No newline at end of file
@@ -17,7 +17,14 @@
 
 #include "ext.h"
 #include "ext_obex.h"
+#include "ext_buffer.h"
 #include "args_util.h"
+#include "max_util.h"
+#include "panlaw.h"
+#include "vbap.h"
+#include "dbap.h"
+#include "ambi.h"
+#include "gcache.h"
 #include <math.h>
 
 //==============================================================================
@@ -28,23 +35,93 @@
 #define M_LN10    2.30258509299404568402
 #define M_LN10_20 0.115129254649702284201
 
+// Panning modes
+#define MODE_LINE 0
+#define MODE_VBAP 1
+#define MODE_DBAP 2
+#define MODE_AMBI 3
+
+// Output modes
+#define OUTMODE_OUTLETS 0
+#define OUTMODE_LIST    1
+
+// Gain cache: at most 2^20 gains in all, 8 MB, whatever the channel count
+#define CACHE_GAINS_MAX 0x100000
+
 //==============================================================================
-//  Structure declaration for the object
+//  Structure declarations
 //==============================================================================
 
+//******************************************************************************
+//  Per channel state, interleaved for the output loop.
+//
+typedef struct _multigain_chan {
+
+  double gain;
+  double adjust;
+  double last;    // last value output, for the delta mode
+  void* outlet;
+
+} t_multigain_chan;
+
+//******************************************************************************
+//  Structure declaration for the object.
+//
 typedef struct _multigain {
 
   t_object obj;
 
-  // Outlets
-  void** outlets;
-  double* gains_chan;
-  double* gains_adjust;
+  // Per channel gains and outlets
+  t_multigain_chan* chans;
   double  gain;
   t_uint8 chan_cnt;
 
+  // Pan law table: shared for the built-in laws
+  const double* panlaw;
+  double* panlaw_custom;
+
+  // Speaker layout for VBAP
+  t_vbap vbap;
+
+  // Speaker positions for DBAP
+  t_dbap dbap;
+
+  // List output: outlet and preallocated atoms
+  void* outlet_list;
+  t_atom* atoms;
+
+  // Batch output: atoms grown on demand, or a buffer~
+  t_atom* batch_atoms;
+  long batch_size;
+  t_buffer_ref* batch_buf;
+
+  // Cache of gain vectors, and the key of the last lookup
+  t_gcache cache;
+  t_int64 cache_key[GCACHE_KEY_LEN];
+
+  // Coalescing: the last position input, output by the clock
+  void* clock;
+  t_symbol* pend_sym;
+  long pend_argc;
+  t_atom pend_argv[3];
+  t_bool pending;
+  t_bool flushing;
+
   // Attributes
   char a_verbose;
+  char a_mode;
+  char a_outmode;
+  char a_delta;
+  double a_epsilon;
+  char a_panlaw;
+  double a_rolloff;
+  double a_blur;
+  char a_coalesce;
+  double a_interval;
+  char a_order;
+  char a_norm;
+  long a_cache;
+  double a_resolution;
 
 } t_multigain;
 
@@ -72,6 +149,34 @@ void multigain_adjust(
 void multigain_adjust_one(
   t_multigain* x, t_symbol* sym, long argc, t_atom* argv);
 void multigain_report(t_multigain* x);
+void multigain_panlaw_custom(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv);
+
+void multigain_batch(t_multigain* x, t_symbol* sym, long argc, t_atom* argv);
+void multigain_batch_buffer(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv);
+void multigain_speakers(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv);
+void multigain_vbap(t_multigain* x, double azi, double ele);
+void multigain_positions(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv);
+void multigain_dbap(t_multigain* x, double px, double py, double pz);
+t_bool multigain_coalesce(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv);
+void multigain_tick(t_multigain* x);
+void multigain_ambi(t_multigain* x, double azi, double ele);
+t_max_err multigain_set_order(
+  t_multigain* x, t_object* attr, long argc, t_atom* argv);
+t_max_err multigain_set_param(
+  t_multigain* x, t_object* attr, long argc, t_atom* argv);
+t_max_err multigain_set_cache(
+  t_multigain* x, t_object* attr, long argc, t_atom* argv);
+t_max_err multigain_notify(t_multigain* x, t_symbol* sym, t_symbol* msg,
+  void* sender, void* data);
+
+// Attribute setters
+t_max_err multigain_set_panlaw(
+  t_multigain* x, t_object* attr, long argc, t_atom* argv);
 
 //==============================================================================
 //  Class definition and life cycle
@@ -102,6 +207,14 @@ void C74_EXPORT ext_main(void* r) {
   class_addmethod(c, (method)multigain_adjust, "adjust", A_GIMME, 0);
   class_addmethod(c, (method)multigain_adjust_one, "adjust_one", A_GIMME, 0);
   class_addmethod(c, (method)multigain_report, "report", 0);
+  class_addmethod(c, (method)multigain_panlaw_custom, "panlaw_custom",
+    A_GIMME, 0);
+  class_addmethod(c, (method)multigain_batch, "batch", A_GIMME, 0);
+  class_addmethod(c, (method)multigain_batch_buffer, "batch_buffer",
+    A_GIMME, 0);
+  class_addmethod(c, (method)multigain_notify, "notify", A_CANT, 0);
+  class_addmethod(c, (method)multigain_speakers, "speakers", A_GIMME, 0);
+  class_addmethod(c, (method)multigain_positions, "positions", A_GIMME, 0);
 
   // Attribute: 'verbose' to turn warnings on or off
   CLASS_ATTR_CHAR(c, "verbose", 0, t_multigain, a_verbose);
@@ -111,6 +224,115 @@ void C74_EXPORT ext_main(void* r) {
   CLASS_ATTR_SAVE(c, "verbose", 0);
   CLASS_ATTR_SELFSAVE(c, "verbose", 0);
 
+  // Attribute: 'mode' to select the panning algorithm
+  CLASS_ATTR_CHAR(c, "mode", 0, t_multigain, a_mode);
+  CLASS_ATTR_ORDER(c, "mode", 0, "0");
+  CLASS_ATTR_ENUMINDEX(c, "mode", 0, "line vbap dbap ambisonic");
+  CLASS_ATTR_LABEL(c, "mode", 0, "Panning mode");
+  CLASS_ATTR_SAVE(c, "mode", 0);
+  CLASS_ATTR_SELFSAVE(c, "mode", 0);
+
+  // Attribute: 'outmode' to output one float per outlet or a single list
+  CLASS_ATTR_CHAR(c, "outmode", 0, t_multigain, a_outmode);
+  CLASS_ATTR_ORDER(c, "outmode", 0, "1");
+  CLASS_ATTR_ENUMINDEX(c, "outmode", 0, "outlets list");
+  CLASS_ATTR_LABEL(c, "outmode", 0, "Output mode");
+  CLASS_ATTR_SAVE(c, "outmode", 0);
+  CLASS_ATTR_SELFSAVE(c, "outmode", 0);
+
+  // Attribute: 'delta' to output only the channels that changed
+  CLASS_ATTR_CHAR(c, "delta", 0, t_multigain, a_delta);
+  CLASS_ATTR_ORDER(c, "delta", 0, "3");
+  CLASS_ATTR_STYLE(c, "delta", 0, "onoff");
+  CLASS_ATTR_LABEL(c, "delta", 0, "Output changes only");
+  CLASS_ATTR_SAVE(c, "delta", 0);
+  CLASS_ATTR_SELFSAVE(c, "delta", 0);
+
+  // Attribute: 'epsilon' as the smallest change output in delta mode
+  CLASS_ATTR_DOUBLE(c, "epsilon", 0, t_multigain, a_epsilon);
+  CLASS_ATTR_ORDER(c, "epsilon", 0, "4");
+  CLASS_ATTR_FILTER_MIN(c, "epsilon", 0);
+  CLASS_ATTR_LABEL(c, "epsilon", 0, "Delta mode threshold");
+  CLASS_ATTR_SAVE(c, "epsilon", 0);
+  CLASS_ATTR_SELFSAVE(c, "epsilon", 0);
+
+  // Attribute: 'panlaw' to select a precomputed pan law
+  CLASS_ATTR_CHAR(c, "panlaw", 0, t_multigain, a_panlaw);
+  CLASS_ATTR_ORDER(c, "panlaw", 0, "5");
+  CLASS_ATTR_ENUMINDEX(c, "panlaw", 0,
+    "sincos equal_power linear compromise custom");
+  CLASS_ATTR_LABEL(c, "panlaw", 0, "Pan law");
+  CLASS_ATTR_SAVE(c, "panlaw", 0);
+  CLASS_ATTR_SELFSAVE(c, "panlaw", 0);
+  CLASS_ATTR_ACCESSORS(c, "panlaw", NULL, multigain_set_panlaw);
+
+  // Attribute: 'rolloff' in dB per doubling of distance for DBAP
+  CLASS_ATTR_DOUBLE(c, "rolloff", 0, t_multigain, a_rolloff);
+  CLASS_ATTR_ORDER(c, "rolloff", 0, "6");
+  CLASS_ATTR_FILTER_MIN(c, "rolloff", 0);
+  CLASS_ATTR_LABEL(c, "rolloff", 0, "DBAP rolloff (dB)");
+  CLASS_ATTR_ACCESSORS(c, "rolloff", NULL, multigain_set_param);
+  CLASS_ATTR_SAVE(c, "rolloff", 0);
+  CLASS_ATTR_SELFSAVE(c, "rolloff", 0);
+
+  // Attribute: 'blur' as the spatial blur for DBAP
+  CLASS_ATTR_DOUBLE(c, "blur", 0, t_multigain, a_blur);
+  CLASS_ATTR_ORDER(c, "blur", 0, "7");
+  CLASS_ATTR_FILTER_MIN(c, "blur", 0);
+  CLASS_ATTR_LABEL(c, "blur", 0, "DBAP spatial blur");
+  CLASS_ATTR_ACCESSORS(c, "blur", NULL, multigain_set_param);
+  CLASS_ATTR_SAVE(c, "blur", 0);
+  CLASS_ATTR_SELFSAVE(c, "blur", 0);
+
+  // Attribute: 'coalesce' to output at most once per interval
+  CLASS_ATTR_CHAR(c, "coalesce", 0, t_multigain, a_coalesce);
+  CLASS_ATTR_ORDER(c, "coalesce", 0, "8");
+  CLASS_ATTR_STYLE(c, "coalesce", 0, "onoff");
+  CLASS_ATTR_LABEL(c, "coalesce", 0, "Coalesce position input");
+  CLASS_ATTR_SAVE(c, "coalesce", 0);
+  CLASS_ATTR_SELFSAVE(c, "coalesce", 0);
+
+  // Attribute: 'interval' in ms for coalescing, 0 for every scheduler tick
+  CLASS_ATTR_DOUBLE(c, "interval", 0, t_multigain, a_interval);
+  CLASS_ATTR_ORDER(c, "interval", 0, "9");
+  CLASS_ATTR_FILTER_MIN(c, "interval", 0);
+  CLASS_ATTR_LABEL(c, "interval", 0, "Coalescing interval (ms)");
+  CLASS_ATTR_SAVE(c, "interval", 0);
+  CLASS_ATTR_SELFSAVE(c, "interval", 0);
+
+  // Attribute: 'order' of the ambisonic encoding
+  CLASS_ATTR_CHAR(c, "order", 0, t_multigain, a_order);
+  CLASS_ATTR_ORDER(c, "order", 0, "10");
+  CLASS_ATTR_LABEL(c, "order", 0, "Ambisonic order");
+  CLASS_ATTR_ACCESSORS(c, "order", NULL, multigain_set_order);
+  CLASS_ATTR_SAVE(c, "order", 0);
+  CLASS_ATTR_SELFSAVE(c, "order", 0);
+
+  // Attribute: 'norm' to select the ambisonic normalization
+  CLASS_ATTR_CHAR(c, "norm", 0, t_multigain, a_norm);
+  CLASS_ATTR_ORDER(c, "norm", 0, "11");
+  CLASS_ATTR_ENUMINDEX(c, "norm", 0, "sn3d n3d");
+  CLASS_ATTR_LABEL(c, "norm", 0, "Ambisonic normalization");
+  CLASS_ATTR_ACCESSORS(c, "norm", NULL, multigain_set_param);
+  CLASS_ATTR_SAVE(c, "norm", 0);
+  CLASS_ATTR_SELFSAVE(c, "norm", 0);
+
+  // Attribute: 'cache' as the number of gain vectors cached, 0 for none
+  CLASS_ATTR_LONG(c, "cache", 0, t_multigain, a_cache);
+  CLASS_ATTR_ORDER(c, "cache", 0, "12");
+  CLASS_ATTR_LABEL(c, "cache", 0, "Gain cache size");
+  CLASS_ATTR_ACCESSORS(c, "cache", NULL, multigain_set_cache);
+  CLASS_ATTR_SAVE(c, "cache", 0);
+  CLASS_ATTR_SELFSAVE(c, "cache", 0);
+
+  // Attribute: 'resolution' of the positions used as cache keys
+  CLASS_ATTR_DOUBLE(c, "resolution", 0, t_multigain, a_resolution);
+  CLASS_ATTR_ORDER(c, "resolution", 0, "13");
+  CLASS_ATTR_LABEL(c, "resolution", 0, "Gain cache resolution");
+  CLASS_ATTR_ACCESSORS(c, "resolution", NULL, multigain_set_param);
+  CLASS_ATTR_SAVE(c, "resolution", 0);
+  CLASS_ATTR_SELFSAVE(c, "resolution", 0);
+
   class_register(CLASS_BOX, c);
   multigain_class = c;
 }
@@ -128,12 +350,13 @@ void* multigain_new(t_symbol* sym, long argc, t_atom* argv) {
     return NULL;
   }
 
-  // Process arguments: get the number of channels
+  // Process arguments: get the number of channels, before the attributes
+  long arg_cnt = attr_args_offset((short)argc, argv);
   t_atom_long cnt = 0;
-  if (argc == 0) {
+  if (arg_cnt == 0) {
     x->chan_cnt = 2;
   }
-  else if ((argc == 1)
+  else if ((arg_cnt == 1)
       && (atom_gettype(argv) == A_LONG)
       && ((cnt = atom_getlong(argv)) >= 2)
       && (cnt <= 0xFF)) {
@@ -144,27 +367,62 @@ void* multigain_new(t_symbol* sym, long argc, t_atom* argv) {
     WARN("Invalid arg(0): [int: 2-255] - number of channels");
   }
 
-  // Allocate dynamic arrays
-  x->outlets = NULL;
-  x->gains_chan = NULL;
-  x->gains_adjust = NULL;
-  x->outlets = (void**)sysmem_newptr(x->chan_cnt * sizeof(void*));
-  x->gains_chan = (double*)sysmem_newptr(x->chan_cnt * sizeof(double));
-  x->gains_adjust = (double*)sysmem_newptr(x->chan_cnt * sizeof(double));
-  if ((!x->outlets) || (!x->gains_chan) || (!x->gains_chan)) {
-    multigain_free(x);
+  x->panlaw_custom = NULL;
+  x->batch_atoms = NULL;
+  x->batch_size = 0;
+  x->batch_buf = NULL;
+  x->vbap.sets = NULL;
+  x->vbap.vecs = NULL;
+  x->vbap.set_cnt = 0;
+  x->dbap.x = NULL;
+  x->dbap.spk_cnt = 0;
+  x->clock = clock_new(x, (method)multigain_tick);
+  x->cache.keys = NULL;
+  x->cache.cap = 0;
+  x->cache.hits = 0;
+  x->cache.misses = 0;
+  x->pending = false;
+  x->flushing = false;
+
+  // Allocate the per channel state and the output atoms in one block:
+  // two atoms per channel for index and value pairs in delta mode
+  x->chans = (t_multigain_chan*)sysmem_newptr_aligned(
+    x->chan_cnt * (sizeof(t_multigain_chan) + 2 * sizeof(t_atom)),
+    CACHE_LINE);
+  if (!x->chans) {
     object_error((t_object*)x, "Allocation error");
+    multigain_free(x);
     return NULL;
   }
+  x->atoms = (t_atom*)(x->chans + x->chan_cnt);
 
   // Initialize
   x->gain = 1.0;
+  x->a_mode = MODE_LINE;
+  x->a_outmode = OUTMODE_OUTLETS;
+  x->a_delta = 0;
+  x->a_epsilon = 0.0;
+  x->a_panlaw = PANLAW_SINCOS;
+  x->panlaw = panlaw_table(PANLAW_SINCOS);
+  x->a_rolloff = 6.0;
+  x->a_blur = 0.01;
+  x->a_coalesce = 0;
+  x->a_interval = 0.0;
+  x->a_order = (x->chan_cnt >= AMBI_CNT(1)) ? 1 : 0;
+  x->a_norm = AMBI_SN3D;
+  x->a_cache = 0;
+  x->a_resolution = 0.001;
+  x->outlet_list = listout(x);  // Rightmost outlet
   for (int i = x->chan_cnt - 1; i >= 0; i--) {  // Outlet 0 is leftmost
-    x->outlets[i] = floatout(x);
-    x->gains_chan[i] = 0.0;
-    x->gains_adjust[i] = 1.0;
+    x->chans[i].outlet = floatout(x);
+    x->chans[i].gain = 0.0;
+    x->chans[i].adjust = 1.0;
+    x->chans[i].last = HUGE_VAL;  // Never a gain, to force the first output
   }
 
+  // Process the attribute arguments, once the state they act on is set
+  attr_args_process(x, (short)argc, argv);
+
   return x;
 }
 
@@ -173,12 +431,19 @@ void* multigain_new(t_symbol* sym, long argc, t_atom* argv) {
 //
 void multigain_free(t_multigain* x) {
 
-  if (x->outlets) { sysmem_freeptr(x->outlets); }
-  if (x->gains_chan) { sysmem_freeptr(x->gains_chan); }
-  if (x->gains_adjust) { sysmem_freeptr(x->gains_adjust); }
-  x->outlets = NULL;
-  x->gains_chan = NULL;
-  x->gains_adjust = NULL;
+  sysmem_freeptr_aligned(x->chans);
+  x->chans = NULL;
+  if (x->panlaw_custom) { sysmem_freeptr(x->panlaw_custom); }
+  if (x->batch_atoms) { sysmem_freeptr(x->batch_atoms); }
+  if (x->batch_buf) { object_free(x->batch_buf); }
+  x->panlaw_custom = NULL;
+  x->batch_atoms = NULL;
+  x->batch_buf = NULL;
+  vbap_clear(&x->vbap);
+  dbap_clear(&x->dbap);
+  if (x->clock) { object_free(x->clock); }
+  x->clock = NULL;
+  gcache_free(&x->cache);
 }
 
 //******************************************************************************
@@ -189,42 +454,212 @@ void multigain_assist(t_multigain* x, void* b, long msg, long arg, char* str) {
   if (msg == ASSIST_INLET) {
     switch (arg) {
     case 0:
-      sprintf(str, "Number, list or message to be rounded down.");
+      sprintf(str, "Pan position (int / float) or message.");
       break;
     default:
       break;
     }
   }
   else if (msg == ASSIST_OUTLET) {
-    switch (arg) {
-    case 0:
-      sprintf(str, "Rounded down values from input. Symbols are passed unchanged.");
-      break;
-    default:
-      break;
+    if (arg < x->chan_cnt) {
+      sprintf(str, "Gain for channel %i (float)", (int)arg);
+    }
+    else {
+      sprintf(str, "Gains for all channels, in list mode (list)");
+    }
+  }
+}
+
+//******************************************************************************
+//  Calculate the pair of adjacent channels and their gains for a position.
+//
+//  @param val The pan position, from 0 to chan_cnt - 1.
+//  @param gain_0 The gain of the returned channel.
+//  @param gain_1 The gain of the next channel.
+//
+//  @return The index of the first channel of the pair.
+//
+static inline int multigain_pan_pair(
+  t_multigain* x, double val, double* gain_0, double* gain_1) {
+
+  if (val <= 0) {
+    *gain_0 = 1;
+    *gain_1 = 0;
+    return 0;
+  }
+  else if (val >= x->chan_cnt - 1) {
+    *gain_0 = 0;
+    *gain_1 = 1;
+    return x->chan_cnt - 2;
+  }
+  else {
+    int index = (int)val;
+    panlaw_eval_pair(x->panlaw, val - index, gain_0, gain_1);
+    return index;
+  }
+}
+
+//******************************************************************************
+//  Calculate the gains of one source in the current mode.
+//
+//  @param pos The position: the pan position in line mode, the azimuth and
+//    elevation in vbap and ambisonic modes, x, y and z in dbap mode.
+//  @param gains The chan_cnt gains, before the master and adjustment gains.
+//
+static void multigain_calc(t_multigain* x, double* pos, double* gains) {
+
+  int spk[3];
+  double g[3];
+  int cnt;
+
+  for (int i = 0; i < x->chan_cnt; i++) {
+    gains[i] = 0;
+  }
+
+  switch (x->a_mode) {
+  case MODE_LINE:
+    cnt = multigain_pan_pair(x, pos[0], g, g + 1);
+    gains[cnt] = g[0];
+    gains[cnt + 1] = g[1];
+    break;
+  case MODE_VBAP:
+    cnt = vbap_pan(&x->vbap, pos[0], pos[1], spk, g);
+    for (int j = 0; j < cnt; j++) {
+      gains[spk[j]] = g[j];
+    }
+    break;
+  case MODE_DBAP:
+    if (!x->dbap.spk_cnt) { break; }
+    dbap_pan(&x->dbap, pos[0], pos[1], pos[2], x->a_rolloff, x->a_blur);
+    for (int i = 0; i < x->dbap.spk_cnt; i++) {
+      gains[i] = x->dbap.g[i];
     }
+    break;
+  case MODE_AMBI: {
+    double coeffs[AMBI_CNT(AMBI_ORDER_MAX)];
+    cnt = MIN(AMBI_CNT(x->a_order), x->chan_cnt);
+    ambi_encode(x->a_order, (t_ambi_norm)x->a_norm, pos[0], pos[1], coeffs);
+    for (int i = 0; i < cnt; i++) {
+      gains[i] = coeffs[i];
+    }
+    break;
+  }
+  }
+}
+
+//******************************************************************************
+//  Calculate the gains of the channels for a position, in the current mode.
+//
+static void multigain_calc_chans(t_multigain* x, double* pos) {
+
+  double gains[0xFF];
+  multigain_calc(x, pos, gains);
+  for (int i = 0; i < x->chan_cnt; i++) {
+    x->chans[i].gain = gains[i];
   }
 }
 
 //******************************************************************************
 //  Output the gains.
 //
-inline void multigain_output(t_multigain* x) {
+//  In delta mode only the channels that changed by more than epsilon are
+//  output: one outlet each, or as a list of index and value pairs.
+//
+//  @param all Output all the channels, even in delta mode.
+//
+inline void multigain_output(t_multigain* x, t_bool all) {
+
+  t_multigain_chan* chan;
+  double val;
+  all = all || !x->a_delta;
+
+  if (x->a_outmode == OUTMODE_LIST) {
+    if (all) {
+      for (int i = 0; i < x->chan_cnt; i++) {
+        chan = x->chans + i;
+        chan->last = x->gain * chan->gain * chan->adjust;
+        atom_setfloat(x->atoms + i, chan->last);
+      }
+      outlet_list(x->outlet_list, NULL, x->chan_cnt, x->atoms);
+    }
+    else {
+      short cnt = 0;
+      for (int i = 0; i < x->chan_cnt; i++) {
+        chan = x->chans + i;
+        val = x->gain * chan->gain * chan->adjust;
+        if (fabs(val - chan->last) > x->a_epsilon) {
+          chan->last = val;
+          atom_setlong(x->atoms + cnt++, i);
+          atom_setfloat(x->atoms + cnt++, val);
+        }
+      }
+      if (cnt) { outlet_list(x->outlet_list, NULL, cnt, x->atoms); }
+    }
+  }
+  else {
+    for (int i = x->chan_cnt - 1; i >= 0; i--) {
+      chan = x->chans + i;
+      val = x->gain * chan->gain * chan->adjust;
+      if (all || (fabs(val - chan->last) > x->a_epsilon)) {
+        chan->last = val;
+        outlet_float(chan->outlet, val);
+      }
+    }
+  }
+}
+
+//******************************************************************************
+//  Look up the gains for a position in the cache.
+//
+//  The position is quantized to the cache resolution in place, so that a
+//  miss calculates the gains stored for the whole quantization step.
+//
+//  @param pos The position values, modified.
+//  @param cnt The number of position values, up to 3.
+//
+//  @return true if the gains were found and output.
+//
+static t_bool multigain_cache_get(t_multigain* x, double* pos, int cnt) {
 
-  for (int i = x->chan_cnt - 1; i >= 0; i--) {
-    post("%i - %.3f %.3f %.3f", i, x->gain, x->gains_chan[i], x->gains_adjust[i]);
-    outlet_float(x->outlets[i],
-      x->gain * x->gains_chan[i] * x->gains_adjust[i]);
+  if (x->cache.cap == 0) { return false; }
+
+  x->cache_key[0] = x->a_mode;
+  for (int i = 0; i < GCACHE_KEY_LEN - 1; i++) {
+    x->cache_key[i + 1] = 0;
+    if (i < cnt) {
+      x->cache_key[i + 1] = (t_int64)floor(pos[i] / x->a_resolution + 0.5);
+      pos[i] = x->cache_key[i + 1] * x->a_resolution;
+    }
+  }
+
+  double* gains = gcache_get(&x->cache, x->cache_key);
+  if (!gains) { return false; }
+  for (int i = 0; i < x->chan_cnt; i++) {
+    x->chans[i].gain = gains[i];
   }
+  multigain_output(x, false);
+  return true;
 }
 
 //******************************************************************************
-//  Process incoming integers.
+//  Store the gains for the key of the last cache miss.
+//
+static void multigain_cache_put(t_multigain* x) {
+
+  if (x->cache.cap == 0) { return; }
+
+  double* gains = gcache_put(&x->cache, x->cache_key);
+  for (int i = 0; i < x->chan_cnt; i++) {
+    gains[i] = x->chans[i].gain;
+  }
+}
+
+//******************************************************************************
+//  Output all the gains.
 //
 void multigain_bang(t_multigain* x) {
 
-  dstr_test();
-  multigain_output(x);
+  multigain_output(x, true);
 }
 
 //******************************************************************************
@@ -232,14 +667,31 @@ void multigain_bang(t_multigain* x) {
 //
 void multigain_int(t_multigain* x, long val) {
 
+  t_atom atom;
+  atom_setlong(&atom, val);
+  if (multigain_coalesce(x, gensym("int"), 1, &atom)) { return; }
+
+  if (x->a_mode == MODE_VBAP) {
+    multigain_vbap(x, (double)val, 0);
+    return;
+  }
+  if (x->a_mode == MODE_AMBI) {
+    multigain_ambi(x, (double)val, 0);
+    return;
+  }
+  if (x->a_mode == MODE_DBAP) {
+    multigain_dbap(x, (double)val, 0, 0);
+    return;
+  }
+
   // Initialize to 0
   for (int i = 0; i < x->chan_cnt; i++) {
-    x->gains_chan[i] = 0;
+    x->chans[i].gain = 0;
   }
   // Calculate pan values
-  x->gains_chan[CLIP(val, 0, x->chan_cnt - 1)] = 1;
+  x->chans[CLIP(val, 0, x->chan_cnt - 1)].gain = 1;
 
-  multigain_output(x);
+  multigain_output(x, false);
 }
 
 //******************************************************************************
@@ -247,26 +699,29 @@ void multigain_int(t_multigain* x, long val) {
 //
 void multigain_float(t_multigain* x, double val) {
 
-  // Initialize to 0
-  for (int i = 0; i < x->chan_cnt; i++) {
-    x->gains_chan[i] = 0;
-  }
+  t_atom atom;
+  atom_setfloat(&atom, val);
+  if (multigain_coalesce(x, gensym("float"), 1, &atom)) { return; }
 
-  // Calculate pan values
-  if (val <= 0) {
-    x->gains_chan[0] = 1;
+  if (x->a_mode == MODE_VBAP) {
+    multigain_vbap(x, val, 0);
+    return;
   }
-  else if (val >= x->chan_cnt - 1) {
-    x->gains_chan[x->chan_cnt - 1] = 1;
+  if (x->a_mode == MODE_AMBI) {
+    multigain_ambi(x, val, 0);
+    return;
   }
-  else {
-    int index = (int)val;
-    double r = cos((val - index) * M_PI_2);
-    x->gains_chan[index] = r;
-    x->gains_chan[index + 1] = sqrt(1 - r * r);
+  if (x->a_mode == MODE_DBAP) {
+    multigain_dbap(x, val, 0, 0);
+    return;
   }
 
-  multigain_output(x);
+  if (multigain_cache_get(x, &val, 1)) { return; }
+
+  multigain_calc_chans(x, &val);
+
+  multigain_cache_put(x);
+  multigain_output(x, false);
 }
 
 //******************************************************************************
@@ -274,6 +729,22 @@ void multigain_float(t_multigain* x, double val) {
 //
 void multigain_list(t_multigain* x, t_symbol* sym, long argc, t_atom* argv) {
 
+  if (multigain_coalesce(x, gensym("list"), argc, argv)) { return; }
+
+  if (((x->a_mode == MODE_VBAP) || (x->a_mode == MODE_AMBI))
+    && args_count_is_between(x, sym, argc, 1, 2)
+    && args_are_numbers(x, sym, argv, 0, (short)argc, NULL, 0, 0)) {
+    double azi = atom_getfloat(argv);
+    double ele = (argc == 2) ? atom_getfloat(argv + 1) : 0;
+    if (x->a_mode == MODE_VBAP) { multigain_vbap(x, azi, ele); }
+    else { multigain_ambi(x, azi, ele); }
+  }
+  else if ((x->a_mode == MODE_DBAP)
+    && args_count_is_between(x, sym, argc, 2, 3)
+    && args_are_numbers(x, sym, argv, 0, (short)argc, NULL, 0, 0)) {
+    multigain_dbap(x, atom_getfloat(argv), atom_getfloat(argv + 1),
+      (argc == 3) ? atom_getfloat(argv + 2) : 0);
+  }
 }
 
 //******************************************************************************
@@ -284,6 +755,16 @@ void multigain_anything(
 
 }
 
+//******************************************************************************
+//  Copy the adjustment gains to the DBAP speaker weights.
+//
+static void multigain_dbap_weights(t_multigain* x) {
+
+  for (int i = 0; i < x->dbap.spk_cnt; i++) {
+    x->dbap.w[i] = x->chans[i].adjust;
+  }
+}
+
 //******************************************************************************
 //  Set the adjustment gains.
 //
@@ -297,15 +778,17 @@ void multigain_adjust(
     if (atom_getsym(argv) == gensym("ampl")
       && args_are_numbers(x, sym, argv, 1, x->chan_cnt, is_above_f, 0, 0)) {
       for (int i = 0; i < x->chan_cnt; i++) {
-        x->gains_adjust[i] = atom_getfloat(argv + i + 1);
+        x->chans[i].adjust = atom_getfloat(argv + i + 1);
       }
     }
     else if (atom_getsym(argv) == gensym("db")
       && args_are_numbers(x, sym, argv, 1, x->chan_cnt, NULL, 0, 0)) {
       for (int i = 0; i < x->chan_cnt; i++) {
-        x->gains_adjust[i] = exp(atom_getfloat(argv + i + 1) * M_LN10_20);
+        x->chans[i].adjust = exp(atom_getfloat(argv + i + 1) * M_LN10_20);
       }
     }
+    multigain_dbap_weights(x);
+    gcache_clear(&x->cache);
   }
 }
 
@@ -322,14 +805,16 @@ void multigain_adjust_one(
 
     if ((atom_getsym(argv) == gensym("ampl"))
       && args_is_number(x, sym, argv, 2, is_above_f, 0, 0)) {
-      x->gains_adjust[atom_getlong(argv + 1)] =
+      x->chans[atom_getlong(argv + 1)].adjust =
         atom_getfloat(argv + 2);
     }
     else if ((atom_getsym(argv) == gensym("db"))
       && args_is_number(x, sym, argv, 2, NULL, 0, 0)) {
-      x->gains_adjust[atom_getlong(argv + 1)] =
+      x->chans[atom_getlong(argv + 1)].adjust =
         exp(atom_getfloat(argv + 2) * M_LN10_20);
     }
+    multigain_dbap_weights(x);
+    gcache_clear(&x->cache);
   }
 }
 
@@ -343,11 +828,436 @@ void multigain_report(t_multigain* x) {
   POST("%s", dstr->cstr);
   dstr_clear(dstr);
   dstr_cat_cstr(dstr, "    Channel gains: ");
-  dstr_cat_join_floats(dstr, x->chan_cnt, x->gains_chan, 4, ", ");
+  dstr_cat_join_floats_stride(dstr, x->chan_cnt, &x->chans[0].gain,
+    sizeof(t_multigain_chan) / sizeof(double), 4, ", ");
   POST("%s", dstr->cstr);
   dstr_clear(dstr);
   dstr_cat_cstr(dstr, "    Adjust gains:    ");
-  dstr_cat_join_floats(dstr, x->chan_cnt, x->gains_adjust, 4, ", ");
+  dstr_cat_join_floats_stride(dstr, x->chan_cnt, &x->chans[0].adjust,
+    sizeof(t_multigain_chan) / sizeof(double), 4, ", ");
+  POST("%s", dstr->cstr);
+  dstr_clear(dstr);
+  dstr_cat_printf(dstr, "    Cache: %i / %i - Hits: %llu - Misses: %llu",
+    x->cache.cnt, x->cache.cap, x->cache.hits, x->cache.misses);
   POST("%s", dstr->cstr);
   dstr_free(&dstr);
 }
+
+
+//******************************************************************************
+//  Attribute setter for the pan law.
+//
+t_max_err multigain_set_panlaw(
+  t_multigain* x, t_object* attr, long argc, t_atom* argv) {
+
+  t_atom_long law = argc ? atom_getlong(argv) : PANLAW_SINCOS;
+  if ((law < 0) || (law > PANLAW_CUSTOM)) {
+    WARN("panlaw: use sincos, equal_power, linear, compromise or custom.");
+    return MAX_ERR_NONE;
+  }
+  if ((law == PANLAW_CUSTOM) && !x->panlaw_custom) {
+    WARN("panlaw: Set a custom law with panlaw_custom first.");
+    return MAX_ERR_NONE;
+  }
+
+  x->a_panlaw = (char)law;
+  x->panlaw = (law == PANLAW_CUSTOM)
+    ? x->panlaw_custom
+    : panlaw_table((t_panlaw)law);
+  gcache_clear(&x->cache);
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Set a custom pan law from a list of gains, and select it.
+//
+//  The gains are those of the channel being faded out, evenly spaced from
+//  one channel to the next.
+//
+void multigain_panlaw_custom(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  if (!args_count_is_between(x, sym, argc, 2, PANLAW_TABLE_SIZE + 1)
+    || !args_are_numbers(x, sym, argv, 0, (short)argc, is_above_f, 0, 0)) {
+    return;
+  }
+  if (!x->panlaw_custom) {
+    x->panlaw_custom = (double*)sysmem_newptr(
+      (PANLAW_TABLE_SIZE + 1) * sizeof(double));
+    if (!x->panlaw_custom) {
+      object_error((t_object*)x, "panlaw_custom: Allocation error");
+      return;
+    }
+  }
+  panlaw_build_custom(x->panlaw_custom, argc, argv);
+  object_attr_setlong(x, gensym("panlaw"), PANLAW_CUSTOM);
+}
+
+//******************************************************************************
+//  Calculate the gains for a batch of sources.
+//
+//  Each position pans one source in the current mode: one value per source
+//  in line mode, azimuth and elevation in vbap and ambisonic modes, and x,
+//  y and z in dbap mode. The source by channel matrix of gains, including
+//  the adjustment gains, is output as one flat list, or written to the
+//  buffer~ set with 'batch_buffer', one frame per source.
+//
+void multigain_batch(t_multigain* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  if ((argc == 0)
+    || !args_are_numbers(x, sym, argv, 0, (short)MIN(argc, SHRT_MAX),
+      NULL, 0, 0)) {
+    return;
+  }
+
+  int dim = (x->a_mode == MODE_LINE) ? 1 : (x->a_mode == MODE_DBAP) ? 3 : 2;
+  if (argc % dim) {
+    WARN("batch: Expects %i values per source.", dim);
+    return;
+  }
+  argc /= dim;
+
+  double pos[3] = { 0, 0, 0 };
+  double gains[0xFF];
+
+  // Write to the buffer~: one frame per source, one channel per channel
+  if (x->batch_buf) {
+    t_buffer_obj* buf = buffer_ref_getobject(x->batch_buf);
+    float* samples = buf ? buffer_locksamples(buf) : NULL;
+    if (!samples) {
+      if (x->a_verbose) { WARN("batch: Buffer~ not found."); }
+      return;
+    }
+    t_atom_long frames = buffer_getframecount(buf);
+    t_atom_long chans = buffer_getchannelcount(buf);
+    if ((frames < argc) || (chans < x->chan_cnt)) {
+      if (x->a_verbose) {
+        WARN("batch: Buffer~ too small for %i sources and %i channels.",
+          (int)argc, x->chan_cnt);
+      }
+      argc = MIN(argc, frames);
+    }
+
+    float* frame;
+    int cnt = (int)MIN(chans, x->chan_cnt);
+    for (long s = 0; s < argc; s++) {
+      frame = samples + s * chans;
+      for (int j = 0; j < dim; j++) {
+        pos[j] = atom_getfloat(argv + s * dim + j);
+      }
+      multigain_calc(x, pos, gains);
+      for (int i = 0; i < cnt; i++) {
+        frame[i] = (float)(x->gain * gains[i] * x->chans[i].adjust);
+      }
+    }
+    buffer_setdirty(buf);
+    buffer_unlocksamples(buf);
+    outlet_bang(x->outlet_list);
+    return;
+  }
+
+  // Output as a list, limited to SHRT_MAX atoms
+  if (argc * x->chan_cnt > SHRT_MAX) {
+    argc = SHRT_MAX / x->chan_cnt;
+    if (x->a_verbose) { WARN("batch: Clipped to %i sources.", (int)argc); }
+  }
+  long size = argc * x->chan_cnt;
+  if (size > x->batch_size) {
+    t_atom* atoms = (t_atom*)sysmem_resizeptr(
+      x->batch_atoms, size * sizeof(t_atom));
+    if (!atoms) {
+      object_error((t_object*)x, "batch: Allocation error");
+      return;
+    }
+    x->batch_atoms = atoms;
+    x->batch_size = size;
+  }
+
+  t_atom* row;
+  for (long s = 0; s < argc; s++) {
+    row = x->batch_atoms + s * x->chan_cnt;
+    for (int j = 0; j < dim; j++) {
+      pos[j] = atom_getfloat(argv + s * dim + j);
+    }
+    multigain_calc(x, pos, gains);
+    for (int i = 0; i < x->chan_cnt; i++) {
+      atom_setfloat(row + i, x->gain * gains[i] * x->chans[i].adjust);
+    }
+  }
+  outlet_list(x->outlet_list, NULL, (short)size, x->batch_atoms);
+}
+
+//******************************************************************************
+//  Set the buffer~ written by 'batch', or output lists without argument.
+//
+void multigain_batch_buffer(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  if (!args_count_is_between(x, sym, argc, 0, 1)) { return; }
+  if (argc == 0) {
+    if (x->batch_buf) { object_free(x->batch_buf); }
+    x->batch_buf = NULL;
+  }
+  else if (args_is_sym(x, sym, argv, 0, 0, NULL)) {
+    if (!x->batch_buf) {
+      x->batch_buf = buffer_ref_new((t_object*)x, atom_getsym(argv));
+    }
+    else {
+      buffer_ref_set(x->batch_buf, atom_getsym(argv));
+    }
+  }
+}
+
+//******************************************************************************
+//  Forward buffer~ notifications to the batch buffer reference.
+//
+t_max_err multigain_notify(t_multigain* x, t_symbol* sym, t_symbol* msg,
+  void* sender, void* data) {
+
+  if (x->batch_buf) {
+    return buffer_ref_notify(x->batch_buf, sym, msg, sender, data);
+  }
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Set the speaker layout for VBAP, and triangulate it once.
+//
+//  speakers 2d <azi> <azi> ...
+//  speakers 3d <azi> <ele> <azi> <ele> ...
+//
+void multigain_speakers(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  t_symbol* symbols[2] = { gensym("2d"), gensym("3d") };
+  if ((argc == 0) || !args_is_sym(x, sym, argv, 0, 2, symbols)) { return; }
+
+  int dim = (atom_getsym(argv) == gensym("2d")) ? 2 : 3;
+  int cnt = (int)(argc - 1) / (dim - 1);
+  if ((cnt < dim) || (cnt > x->chan_cnt) || ((argc - 1) % (dim - 1))
+    || !args_are_numbers(x, sym, argv, 1, (short)(argc - 1), NULL, 0, 0)) {
+    WARN("speakers: Expects %s for %i to %i speakers.",
+      (dim == 2) ? "azimuths" : "azimuth and elevation pairs",
+      dim, x->chan_cnt);
+    return;
+  }
+
+  double azi[0xFF];
+  double ele[0xFF];
+  for (int i = 0; i < cnt; i++) {
+    azi[i] = atom_getfloat(argv + 1 + (dim - 1) * i);
+    ele[i] = (dim == 3) ? atom_getfloat(argv + 2 + 2 * i) : 0;
+  }
+  t_max_err err = vbap_set_speakers(&x->vbap, dim, cnt, azi, ele);
+  if (err == MAX_ERR_OUT_OF_MEM) {
+    object_error((t_object*)x, "speakers: Allocation error");
+  }
+  else if ((err != MAX_ERR_NONE) && x->vbap.set_cnt) {
+    WARN("speakers: Opposite or coincident speakers leave gaps.");
+  }
+  else if (err != MAX_ERR_NONE) {
+    WARN("speakers: Invalid speaker layout.");
+  }
+  gcache_clear(&x->cache);
+}
+
+//******************************************************************************
+//  Pan a source to a direction with VBAP.
+//
+void multigain_vbap(t_multigain* x, double azi, double ele) {
+
+  double pos[2] = { azi, ele };
+
+  if (multigain_cache_get(x, pos, 2)) { return; }
+
+  multigain_calc_chans(x, pos);
+
+  multigain_cache_put(x);
+  multigain_output(x, false);
+}
+
+//******************************************************************************
+//  Set the speaker positions for DBAP.
+//
+//  positions 2d <x> <y> <x> <y> ...
+//  positions 3d <x> <y> <z> <x> <y> <z> ...
+//
+void multigain_positions(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  t_symbol* symbols[2] = { gensym("2d"), gensym("3d") };
+  if ((argc == 0) || !args_is_sym(x, sym, argv, 0, 2, symbols)) { return; }
+
+  int dim = (atom_getsym(argv) == gensym("2d")) ? 2 : 3;
+  int cnt = (int)(argc - 1) / dim;
+  if ((cnt < 1) || (cnt > x->chan_cnt) || ((argc - 1) % dim)
+    || !args_are_numbers(x, sym, argv, 1, (short)(argc - 1), NULL, 0, 0)) {
+    WARN("positions: Expects %i coordinates for 1 to %i speakers.",
+      dim, x->chan_cnt);
+    return;
+  }
+
+  double pos[3 * 0xFF];
+  for (int i = 0; i < cnt; i++) {
+    pos[3 * i] = atom_getfloat(argv + 1 + dim * i);
+    pos[3 * i + 1] = atom_getfloat(argv + 2 + dim * i);
+    pos[3 * i + 2] = (dim == 3) ? atom_getfloat(argv + 3 + dim * i) : 0;
+  }
+  if (dbap_set_speakers(&x->dbap, cnt, pos) != MAX_ERR_NONE) {
+    object_error((t_object*)x, "positions: Allocation error");
+    return;
+  }
+  multigain_dbap_weights(x);
+  gcache_clear(&x->cache);
+}
+
+//******************************************************************************
+//  Pan a source to a position with DBAP.
+//
+//  The speaker weights are the adjustment gains, applied on output.
+//
+void multigain_dbap(t_multigain* x, double px, double py, double pz) {
+
+  double pos[3] = { px, py, pz };
+
+  if (multigain_cache_get(x, pos, 3)) { return; }
+
+  multigain_calc_chans(x, pos);
+
+  multigain_cache_put(x);
+  multigain_output(x, false);
+}
+
+//******************************************************************************
+//  Store a position input to output it on the next clock tick.
+//
+//  Only the last input before the tick is processed: the ones it replaces
+//  are never calculated nor output.
+//
+//  @return true if the input was stored, false to process it now.
+//
+t_bool multigain_coalesce(
+  t_multigain* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  if (!x->a_coalesce || x->flushing || (argc > 3) || !x->clock) {
+    return false;
+  }
+
+  x->pend_sym = sym;
+  x->pend_argc = argc;
+  for (long i = 0; i < argc; i++) {
+    x->pend_argv[i] = argv[i];
+  }
+  if (!x->pending) {
+    x->pending = true;
+    clock_fdelay(x->clock, x->a_interval);
+  }
+  return true;
+}
+
+//******************************************************************************
+//  Clock callback: process the last stored position input.
+//
+void multigain_tick(t_multigain* x) {
+
+  if (!x->pending) { return; }
+  x->pending = false;
+  x->flushing = true;
+  if (x->pend_sym == gensym("int")) {
+    multigain_int(x, (long)atom_getlong(x->pend_argv));
+  }
+  else if (x->pend_sym == gensym("float")) {
+    multigain_float(x, atom_getfloat(x->pend_argv));
+  }
+  else {
+    multigain_list(x, x->pend_sym, x->pend_argc, x->pend_argv);
+  }
+  x->flushing = false;
+}
+
+//******************************************************************************
+//  Calculate the ambisonic encoding gains for a direction.
+//
+//  The channels beyond the (order + 1)^2 coefficients are set to 0.
+//
+void multigain_ambi(t_multigain* x, double azi, double ele) {
+
+  double pos[2] = { azi, ele };
+
+  if (multigain_cache_get(x, pos, 2)) { return; }
+
+  multigain_calc_chans(x, pos);
+
+  multigain_cache_put(x);
+  multigain_output(x, false);
+}
+
+//******************************************************************************
+//  Attribute setter for the ambisonic order.
+//
+//  The order is limited by the number of channels.
+//
+t_max_err multigain_set_order(
+  t_multigain* x, t_object* attr, long argc, t_atom* argv) {
+
+  t_atom_long order = argc ? atom_getlong(argv) : 1;
+  t_atom_long order_max = 0;
+  while ((order_max < AMBI_ORDER_MAX)
+    && (AMBI_CNT(order_max + 1) <= x->chan_cnt)) {
+    order_max++;
+  }
+  if ((order < 0) || (order > order_max)) {
+    WARN("order: Expects an order from 0 to %i for %i channels.",
+      (int)order_max, x->chan_cnt);
+    order = CLIP(order, 0, order_max);
+  }
+
+  x->a_order = (char)order;
+  gcache_clear(&x->cache);
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Attribute setter for the parameters that the cached gains depend on.
+//
+t_max_err multigain_set_param(
+  t_multigain* x, t_object* attr, long argc, t_atom* argv) {
+
+  if (!argc) { return MAX_ERR_NONE; }
+  t_symbol* name = (t_symbol*)object_method(attr, gensym("getname"));
+  double val = atom_getfloat(argv);
+
+  if (name == gensym("rolloff")) { x->a_rolloff = MAX(val, 0); }
+  else if (name == gensym("blur")) { x->a_blur = MAX(val, 0); }
+  else if (name == gensym("norm")) { x->a_norm = (char)CLIP(val, 0, 1); }
+  else if (name == gensym("resolution")) {
+    if (val <= 0) {
+      WARN("resolution: Expects a value above 0.");
+      return MAX_ERR_NONE;
+    }
+    x->a_resolution = val;
+  }
+  gcache_clear(&x->cache);
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Attribute setter for the cache size.
+//
+t_max_err multigain_set_cache(
+  t_multigain* x, t_object* attr, long argc, t_atom* argv) {
+
+  t_atom_long cap = argc ? atom_getlong(argv) : 0;
+  t_atom_long cap_max = CACHE_GAINS_MAX / x->chan_cnt;
+  if ((cap < 0) || (cap > cap_max)) {
+    WARN("cache: Expects 0 to %i entries for %i channels.",
+      (int)cap_max, x->chan_cnt);
+    cap = CLIP(cap, 0, cap_max);
+  }
+  if (gcache_set_capacity(&x->cache, (int)cap, x->chan_cnt) != MAX_ERR_NONE) {
+    object_error((t_object*)x, "cache: Allocation error");
+    cap = 0;
+  }
+  x->a_cache = (long)cap;
+  return MAX_ERR_NONE;
+}
\ No newline at end of file
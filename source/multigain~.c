@@ -0,0 +1,415 @@
+//==============================================================================
+//
+//  @file multigain~.c
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief A Max external to pan a signal over multiple channels.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "ext.h"
+#include "ext_obex.h"
+#include "z_dsp.h"
+#include "args_util.h"
+#include "max_util.h"
+#include "panlaw.h"
+#include <math.h>
+#include <string.h>
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+#define M_LN10_20 0.115129254649702284201
+
+//==============================================================================
+//  Structure declarations
+//==============================================================================
+
+//******************************************************************************
+//  Structure declaration for the object.
+//
+//  The perform routine works in passes over the whole vector: positions to
+//  channel pairs and fractions, then pan law lookups, then one scatter pass
+//  writing two channels per sample. The scratch arrays hold the results of
+//  the first two passes.
+//
+typedef struct _multigain_tilde {
+
+  t_pxobject obj;
+
+  t_uint8 chan_cnt;
+  double* adjust;   // per channel adjustment gains
+
+  // Position used when no signal is connected to the position inlet
+  double pos;
+
+  // Pan law table: shared for the built-in laws
+  const double* panlaw;
+
+  // Connections, set in the dsp64 method
+  t_bool in_conn;
+  t_bool pos_conn;
+
+  // Scratch arrays, one value per sample, in one block
+  long vec_size;
+  void* block_old;  // replaced block, kept until the next DSP chain is built
+  int* idx;
+  double* frac;
+  double* gain_0;
+  double* gain_1;
+
+  // Attributes
+  char a_verbose;
+  char a_panlaw;
+
+} t_multigain_tilde;
+
+//******************************************************************************
+//  Global pointer to the class.
+//
+static t_class* multigain_tilde_class = NULL;
+
+//==============================================================================
+//  Function declarations
+//==============================================================================
+
+void* multigain_tilde_new(t_symbol* sym, long argc, t_atom* argv);
+void multigain_tilde_free(t_multigain_tilde* x);
+void multigain_tilde_dsp64(t_multigain_tilde* x, t_object* dsp64,
+  short* count, double samplerate, long maxvectorsize, long flags);
+void multigain_tilde_perform64(t_multigain_tilde* x, t_object* dsp64,
+  double** ins, long numins, double** outs, long numouts,
+  long sampleframes, long flags, void* userparam);
+void multigain_tilde_assist(t_multigain_tilde* x, void* b, long msg, long arg,
+  char* str);
+
+void multigain_tilde_int(t_multigain_tilde* x, long val);
+void multigain_tilde_float(t_multigain_tilde* x, double val);
+void multigain_tilde_adjust(
+  t_multigain_tilde* x, t_symbol* sym, long argc, t_atom* argv);
+t_max_err multigain_tilde_set_panlaw(
+  t_multigain_tilde* x, t_object* attr, long argc, t_atom* argv);
+
+//==============================================================================
+//  Function definitions
+//==============================================================================
+
+//******************************************************************************
+//  Create the Max class and initialize it.
+//
+void C74_EXPORT ext_main(void* r) {
+
+  t_class* c;
+
+  c = class_new(
+    "y.multigain~",
+    (method)multigain_tilde_new,
+    (method)multigain_tilde_free,
+    (long)sizeof(t_multigain_tilde),
+    (method)NULL,
+    A_GIMME,
+    0);
+
+  class_addmethod(c, (method)multigain_tilde_dsp64, "dsp64", A_CANT, 0);
+  class_addmethod(c, (method)multigain_tilde_assist, "assist", A_CANT, 0);
+
+  class_addmethod(c, (method)multigain_tilde_int, "int", A_LONG, 0);
+  class_addmethod(c, (method)multigain_tilde_float, "float", A_FLOAT, 0);
+  class_addmethod(c, (method)multigain_tilde_adjust, "adjust", A_GIMME, 0);
+
+  // Attributes
+  CLASS_ATTR_CHAR(c, "verbose", 0, t_multigain_tilde, a_verbose);
+  attr_set_propr(c, "verbose", "2", NULL, "onoff", "Report warnings", "1");
+
+  CLASS_ATTR_CHAR(c, "panlaw", 0, t_multigain_tilde, a_panlaw);
+  CLASS_ATTR_ENUMINDEX(c, "panlaw", 0,
+    "sincos equal_power linear compromise");
+  attr_set_propr(c, "panlaw", "1", NULL, NULL, "Pan law", "0");
+  CLASS_ATTR_ACCESSORS(c, "panlaw", NULL, multigain_tilde_set_panlaw);
+
+  class_dspinit(c);
+  class_register(CLASS_BOX, c);
+  multigain_tilde_class = c;
+}
+
+//******************************************************************************
+//  Create a new instance of the class.
+//
+void* multigain_tilde_new(t_symbol* sym, long argc, t_atom* argv) {
+
+  t_multigain_tilde* x = NULL;
+  x = (t_multigain_tilde*)object_alloc(multigain_tilde_class);
+
+  if (x == NULL) {
+    error("multigain~: Object allocation failed.");
+    return NULL;
+  }
+
+  // Process arguments
+  args_count_is_between(x, sym, argc, 0, 1);
+  x->chan_cnt =
+    (argc >= 1) && args_is_long(x, sym, argv, 0, is_between_l, 2, 0xFF)
+    ? (t_uint8)atom_getlong(argv)
+    : 4;
+
+  // Inlets and outlets: the outputs may not share the input vectors
+  dsp_setup((t_pxobject*)x, 2);
+  for (int i = 0; i < x->chan_cnt; i++) {
+    outlet_new((t_object*)x, "signal");
+  }
+  x->obj.z_misc |= Z_NO_INPLACE;
+
+  // Allocate
+  x->vec_size = 0;
+  x->block_old = NULL;
+  x->idx = NULL;
+  x->adjust = (double*)sysmem_newptr(x->chan_cnt * sizeof(double));
+  if (!x->adjust) {
+    object_error((t_object*)x, "Allocation error");
+    multigain_tilde_free(x);
+    return NULL;
+  }
+
+  // Initialize
+  for (int i = 0; i < x->chan_cnt; i++) {
+    x->adjust[i] = 1.0;
+  }
+  x->pos = 0;
+  x->in_conn = false;
+  x->pos_conn = false;
+  x->a_panlaw = PANLAW_SINCOS;
+  x->panlaw = panlaw_table(PANLAW_SINCOS);
+
+  return x;
+}
+
+//******************************************************************************
+//  Free the instance.
+//
+void multigain_tilde_free(t_multigain_tilde* x) {
+
+  dsp_free((t_pxobject*)x);
+  if (x->adjust) { sysmem_freeptr(x->adjust); }
+  if (x->idx) { sysmem_freeptr_aligned(x->idx); }
+  if (x->block_old) { sysmem_freeptr_aligned(x->block_old); }
+  x->adjust = NULL;
+  x->idx = NULL;
+  x->block_old = NULL;
+}
+
+//******************************************************************************
+//  Called when the DAC is turned on.
+//
+//  The scratch arrays are only reallocated when the vector size grows. The
+//  old chain may still be running on the audio thread, so the replaced
+//  block is only freed on the next call, once the new chain is in place.
+//
+void multigain_tilde_dsp64(t_multigain_tilde* x, t_object* dsp64,
+  short* count, double samplerate, long maxvectorsize, long flags) {
+
+  if (x->block_old) {
+    sysmem_freeptr_aligned(x->block_old);
+    x->block_old = NULL;
+  }
+
+  if (maxvectorsize > x->vec_size) {
+    void* block = sysmem_newptr_aligned(
+      maxvectorsize * (3 * sizeof(double) + sizeof(int)), CACHE_LINE);
+    if (!block) {
+      object_error((t_object*)x, "dsp: Allocation error");
+      return;
+    }
+    x->block_old = x->idx;
+    x->vec_size = maxvectorsize;
+    x->frac = (double*)block;
+    x->gain_0 = x->frac + maxvectorsize;
+    x->gain_1 = x->gain_0 + maxvectorsize;
+    x->idx = (int*)(x->gain_1 + maxvectorsize);
+  }
+
+  x->in_conn = count[0] != 0;
+  x->pos_conn = count[1] != 0;
+  object_method(dsp64, gensym("dsp_add64"), x, multigain_tilde_perform64,
+    0, NULL);
+}
+
+//******************************************************************************
+//  Split a position into a channel pair and a fraction.
+//
+//  A NaN position fails both comparisons, and takes the first pair.
+//
+static inline int multigain_tilde_split(
+  double pos, int last, double* frac) {
+
+  if (!(pos > 0)) {
+    *frac = 0;
+    return 0;
+  }
+  else if (pos >= last) {
+    *frac = 1;
+    return last - 1;
+  }
+  else {
+    int index = (int)pos;
+    *frac = pos - index;
+    return index;
+  }
+}
+
+//******************************************************************************
+//  Perform routine.
+//
+//  Without a signal on the audio inlet, the outputs are the gains.
+//
+void multigain_tilde_perform64(t_multigain_tilde* x, t_object* dsp64,
+  double** ins, long numins, double** outs, long numouts,
+  long sampleframes, long flags, void* userparam) {
+
+  double* in = ins[0];
+  double* pos = ins[1];
+  long n = sampleframes;
+  int last = x->chan_cnt - 1;
+  const double* table = x->panlaw;
+
+  for (int ch = 0; ch < x->chan_cnt; ch++) {
+    memset(outs[ch], 0, n * sizeof(double));
+  }
+
+  // Constant position: one pair of channels for the whole vector
+  if (!x->pos_conn) {
+    double frac;
+    int index = multigain_tilde_split(x->pos, last, &frac);
+    double g_0 = panlaw_eval(table, frac) * x->adjust[index];
+    double g_1 = panlaw_eval(table, 1 - frac) * x->adjust[index + 1];
+    double* out_0 = outs[index];
+    double* out_1 = outs[index + 1];
+    for (long i = 0; i < n; i++) {
+      double val = x->in_conn ? in[i] : 1.0;
+      out_0[i] = g_0 * val;
+      out_1[i] = g_1 * val;
+    }
+    return;
+  }
+
+  // Pass 1: positions to channel pairs and fractions
+  int* idx = x->idx;
+  double* frac = x->frac;
+  for (long i = 0; i < n; i++) {
+    idx[i] = multigain_tilde_split(pos[i], last, frac + i);
+  }
+
+  // Pass 2: pan law lookups for both channels of each pair
+  double* gain_0 = x->gain_0;
+  double* gain_1 = x->gain_1;
+  for (long i = 0; i < n; i++) {
+    gain_0[i] = panlaw_eval(table, frac[i]);
+    gain_1[i] = panlaw_eval(table, 1 - frac[i]);
+  }
+
+  // Pass 3: scatter to the two active channels of each sample
+  double* adjust = x->adjust;
+  if (x->in_conn) {
+    for (long i = 0; i < n; i++) {
+      outs[idx[i]][i] = gain_0[i] * adjust[idx[i]] * in[i];
+      outs[idx[i] + 1][i] = gain_1[i] * adjust[idx[i] + 1] * in[i];
+    }
+  }
+  else {
+    for (long i = 0; i < n; i++) {
+      outs[idx[i]][i] = gain_0[i] * adjust[idx[i]];
+      outs[idx[i] + 1][i] = gain_1[i] * adjust[idx[i] + 1];
+    }
+  }
+}
+
+//******************************************************************************
+//  Assist function.
+//
+void multigain_tilde_assist(t_multigain_tilde* x, void* b, long msg, long arg,
+  char* str) {
+
+  if (msg == ASSIST_INLET) {
+    switch (arg) {
+    case 0:
+      sprintf(str, "Audio input (signal) or message");
+      break;
+    default:
+      sprintf(str, "Pan position (signal / float)");
+      break;
+    }
+  }
+  else if (msg == ASSIST_OUTLET) {
+    sprintf(str, "Channel %i: audio or gain (signal)", (int)arg);
+  }
+}
+
+//******************************************************************************
+//  Set the position used when no signal is connected.
+//
+void multigain_tilde_int(t_multigain_tilde* x, long val) {
+
+  multigain_tilde_float(x, (double)val);
+}
+
+//******************************************************************************
+//  Set the position used when no signal is connected.
+//
+void multigain_tilde_float(t_multigain_tilde* x, double val) {
+
+  if (proxy_getinlet((t_object*)x) != 1) {
+    WARN("float: Set the position in the right inlet.");
+    return;
+  }
+  x->pos = val;
+}
+
+//******************************************************************************
+//  Set the adjustment gains.
+//
+void multigain_tilde_adjust(
+  t_multigain_tilde* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  t_symbol* symbols[2] = { gensym("ampl"), gensym("db") };
+  if (args_count_is(x, sym, argc, x->chan_cnt + 1)
+    && args_is_sym(x, sym, argv, 0, 2, symbols)) {
+
+    if (atom_getsym(argv) == gensym("ampl")
+      && args_are_numbers(x, sym, argv, 1, x->chan_cnt, is_above_f, 0, 0)) {
+      for (int i = 0; i < x->chan_cnt; i++) {
+        x->adjust[i] = atom_getfloat(argv + i + 1);
+      }
+    }
+    else if (atom_getsym(argv) == gensym("db")
+      && args_are_numbers(x, sym, argv, 1, x->chan_cnt, NULL, 0, 0)) {
+      for (int i = 0; i < x->chan_cnt; i++) {
+        x->adjust[i] = exp(atom_getfloat(argv + i + 1) * M_LN10_20);
+      }
+    }
+  }
+}
+
+//******************************************************************************
+//  Attribute setter for the pan law.
+//
+t_max_err multigain_tilde_set_panlaw(
+  t_multigain_tilde* x, t_object* attr, long argc, t_atom* argv) {
+
+  t_atom_long law = argc ? atom_getlong(argv) : PANLAW_SINCOS;
+  if ((law < 0) || (law >= PANLAW_BUILTIN_CNT)) {
+    WARN("panlaw: use sincos, equal_power, linear or compromise.");
+    return MAX_ERR_NONE;
+  }
+
+  x->a_panlaw = (char)law;
+  x->panlaw = panlaw_table((t_panlaw)law);
+  return MAX_ERR_NONE;
+}
@@ -0,0 +1,82 @@
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "panlaw.h"
+#include <math.h>
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+#define M_PI_2 1.57079632679489661923
+
+//==============================================================================
+//  Static variables
+//==============================================================================
+
+static double panlaw_tables[PANLAW_BUILTIN_CNT][PANLAW_TABLE_SIZE + 1];
+static t_bool panlaw_built[PANLAW_BUILTIN_CNT] = { false };
+
+//==============================================================================
+//  Function definitions
+//==============================================================================
+
+//******************************************************************************
+//  Get the table for a built-in pan law, building it on the first call.
+//
+//  @param law The pan law, excluding PANLAW_CUSTOM.
+//
+//  @return A pointer to the PANLAW_TABLE_SIZE + 1 table values.
+//
+const double* panlaw_table(t_panlaw law) {
+
+  if ((law < 0) || (law >= PANLAW_BUILTIN_CNT)) { law = PANLAW_SINCOS; }
+  double* table = panlaw_tables[law];
+  if (panlaw_built[law]) { return table; }
+
+  double frac;
+  for (int i = 0; i <= PANLAW_TABLE_SIZE; i++) {
+    frac = (double)i / PANLAW_TABLE_SIZE;
+    switch (law) {
+    case PANLAW_SINCOS:
+      table[i] = cos(frac * M_PI_2);
+      break;
+    case PANLAW_EQUAL_POWER:
+      table[i] = sqrt(1 - frac);
+      break;
+    case PANLAW_LINEAR:
+      table[i] = 1 - frac;
+      break;
+    case PANLAW_COMPROMISE:
+      table[i] = sqrt((1 - frac) * cos(frac * M_PI_2));
+      break;
+    default:
+      break;
+    }
+  }
+  panlaw_built[law] = true;
+  return table;
+}
+
+//******************************************************************************
+//  Build a custom pan law table from a list of gains.
+//
+//  @param table The PANLAW_TABLE_SIZE + 1 values to fill in.
+//  @param argc The number of gains, at least 2.
+//  @param argv The gains of the channel being faded out, evenly spaced
+//    from a pan fraction of 0 to 1.
+//
+void panlaw_build_custom(double* table, long argc, t_atom* argv) {
+
+  double pos;
+  long index;
+  double val0;
+  for (int i = 0; i <= PANLAW_TABLE_SIZE; i++) {
+    pos = (double)i * (argc - 1) / PANLAW_TABLE_SIZE;
+    index = (long)pos;
+    val0 = atom_getfloat(argv + index);
+    table[i] = (index >= argc - 1) ? val0
+      : val0 + (pos - index) * (atom_getfloat(argv + index + 1) - val0);
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef YC_PANLAW_H_
+#define YC_PANLAW_H_
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "ext.h"
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+// Number of intervals in a pan law table, which holds one extra point
+#define PANLAW_TABLE_SIZE 512
+
+//==============================================================================
+//  Typedef
+//==============================================================================
+
+//******************************************************************************
+//  Pan laws: the order matches the enum of the 'panlaw' attributes.
+//
+typedef enum _panlaw {
+
+  PANLAW_SINCOS,        // cos and sin quarter periods
+  PANLAW_EQUAL_POWER,   // square roots of linear gains
+  PANLAW_LINEAR,        // linear gains
+  PANLAW_COMPROMISE,    // -4.5 dB at the center
+  PANLAW_CUSTOM,        // user defined table
+  PANLAW_BUILTIN_CNT = PANLAW_CUSTOM
+
+} t_panlaw;
+
+//==============================================================================
+//  Function declarations
+//==============================================================================
+
+//******************************************************************************
+//  Get the table for a built-in pan law, building it on the first call.
+//
+//  The tables are shared by all the instances. A table holds the gain of
+//  the channel being faded out, for a pan fraction from 0 to 1.
+//
+//  @param law The pan law, excluding PANLAW_CUSTOM.
+//
+//  @return A pointer to the PANLAW_TABLE_SIZE + 1 table values.
+//
+const double* panlaw_table(t_panlaw law);
+
+//******************************************************************************
+//  Build a custom pan law table from a list of gains.
+//
+//  @param table The PANLAW_TABLE_SIZE + 1 values to fill in.
+//  @param argc The number of gains, at least 2.
+//  @param argv The gains of the channel being faded out, evenly spaced
+//    from a pan fraction of 0 to 1.
+//
+void panlaw_build_custom(double* table, long argc, t_atom* argv);
+
+//******************************************************************************
+//  Evaluate a pan law table, interpolating linearly.
+//
+//  @param table The pan law table.
+//  @param frac The pan fraction, between 0 and 1.
+//
+//  @return The gain of the channel being faded out.
+//
+static inline double panlaw_eval(const double* table, double frac) {
+
+  double pos = frac * PANLAW_TABLE_SIZE;
+  int index = (int)pos;
+  if (index >= PANLAW_TABLE_SIZE) { return table[PANLAW_TABLE_SIZE]; }
+  return table[index] + (pos - index) * (table[index + 1] - table[index]);
+}
+
+//******************************************************************************
+//  Evaluate a pan law table for a pair of channels.
+//
+//  @param table The pan law table.
+//  @param frac The pan fraction, between 0 and 1.
+//  @param gain_0 The gain of the channel at fraction 0.
+//  @param gain_1 The gain of the channel at fraction 1.
+//
+static inline void panlaw_eval_pair(const double* table, double frac,
+  double* gain_0, double* gain_1) {
+
+  *gain_0 = panlaw_eval(table, frac);
+  *gain_1 = panlaw_eval(table, 1 - frac);
+}
+
+#endif
@@ -0,0 +1,32 @@
+//==============================================================================
+//
+//  @file quantize.c
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief A Max external to snap numbers and lists to multiples of a step.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+//==============================================================================
+//  Operation
+//==============================================================================
+
+// The values are snapped to the nearest multiple of the step, halfway
+// values away from zero, and output as floats
+#define ROUND_NAME "quantize"
+#define ROUND_DESC "snapped to the step"
+#define ROUND_STEP
+#define ROUND_SCALAR(x, v) OP_QUANTIZE(v, (x)->a_step)
+#define ROUND_VECTOR(x, v) OP_QUANTIZE_VEC(v, (x)->a_step)
+#define ROUND_UNIT(v) OP_ROUND(v)
+#define ROUND_UNIT_VEC(v) OP_ROUND_VEC(v)
+
+//==============================================================================
+//  Shared engine
+//==============================================================================
+
+#include "rounding.h"
@@ -0,0 +1,28 @@
+//==============================================================================
+//
+//  @file round.c
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief A Max external to round floats and lists to the nearest integer.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+//==============================================================================
+//  Operation
+//==============================================================================
+
+// Halfway values are rounded away from zero
+#define ROUND_NAME "round"
+#define ROUND_DESC "rounded to the nearest integer"
+#define ROUND_SCALAR(x, v) OP_ROUND(v)
+#define ROUND_VECTOR(x, v) OP_ROUND_VEC(v)
+
+//==============================================================================
+//  Shared engine
+//==============================================================================
+
+#include "rounding.h"
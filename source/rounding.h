@@ -0,0 +1,1078 @@
+//==============================================================================
+//
+//  @file rounding.h
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief The shared engine of the rounding externals.
+//
+//  This header is a template for a whole external: it is included once by
+//  each of ceil.c, floor.c, round.c, trunc.c and quantize.c, after these
+//  macros are defined:
+//
+//    ROUND_NAME         The name without prefix, as a C string.
+//    ROUND_DESC         The operation for the assist strings: "rounded up".
+//    ROUND_SCALAR(x, v) The operation on a double.
+//    ROUND_VECTOR(x, v) Optional: the operation on a t_round_vec.
+//    ROUND_STEP         Optional: adds the 'step' attribute, and outputs
+//                       floats, processing ints as well.
+//    ROUND_UNIT(v)      With a step: the operation to whole numbers, on a
+//    ROUND_UNIT_VEC(v)  double and on a t_round_vec, used with the step of
+//                       the 'buffer' message.
+//
+//  Each external gets its own hot loops, with the operation inlined. The
+//  operations and vector primitives are in rounding_ops.h.
+//
+//  Float Jitter matrices are rounded in place: the matrix is modified and
+//  its name passed on, without an intermediate copy. So are dictionaries,
+//  including their atom arrays and nested dictionaries, and buffer~ objects,
+//  with the 'buffer' message, on threads off the main thread.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+#ifndef YC_ROUNDING_H_
+#define YC_ROUNDING_H_
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "ext.h"
+#include "ext_obex.h"
+#include "ext_buffer.h"
+#include "ext_dictobj.h"
+#include "jit.common.h"
+#include "rounding_ops.h"
+#include <ctype.h>
+#include <math.h>
+#include <string.h>
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+#define WARN(...) do { object_warn((t_object*)x, __VA_ARGS__); } while (0)
+
+// Output atom buffer: initial size, and shrinking after a run of messages
+// that would all have fit in a quarter of it
+#define ATOMS_SIZE_MIN 256
+#define SHRINK_RUN 1024
+
+// Number of floats rounded at once from a run of float atoms
+#define RUN_CHUNK 64
+
+// Buffer~ rounding: number of threads, and samples below which one is used
+#define BUFFER_THREADS 4
+#define BUFFER_SPLIT_MIN 262144
+
+// Without a step, the operation is to whole numbers already
+#ifndef ROUND_STEP
+#define ROUND_UNIT(v) ROUND_SCALAR(NULL, v)
+#define ROUND_UNIT_VEC(v) ROUND_VECTOR(NULL, v)
+#endif
+
+// Without a vector operation, or without SIMD, only the scalar loop runs
+#if !defined(ROUND_SIMD) && defined(ROUND_VECTOR)
+#undef ROUND_VECTOR
+#endif
+#if !defined(ROUND_SIMD) && defined(ROUND_UNIT_VEC)
+#undef ROUND_UNIT_VEC
+#endif
+
+//==============================================================================
+//  Typedef
+//==============================================================================
+
+//******************************************************************************
+//  Function pointer to toggle between outputting lists and messages.
+//
+typedef void* (*t_output_func)(void* outlet, t_symbol* sym, short argc,
+    t_atom* argv);
+
+//******************************************************************************
+//  A part of the samples of a buffer~, rounded by one thread.
+//
+typedef struct _buffer_part {
+
+  float* samps;
+  long cnt;
+  double step;
+
+} t_buffer_part;
+
+//==============================================================================
+//  Structure declaration for the object
+//==============================================================================
+
+typedef struct _rounding {
+
+  t_object obj;
+
+  // Outlets
+  void* outl_output;
+
+  // Output atoms, grown to the longest message and reused
+  t_atom* atoms;
+  long atoms_size;
+  long shrink_cnt;    // length of the current run of short messages
+  long shrink_max;    // longest message of the run
+
+  // Buffer~ rounded in place, locked while the job thread runs
+  t_buffer_ref* buf_ref;
+  t_buffer_obj* buf_obj;
+  t_symbol* buf_name;
+  float* buf_samps;
+  long buf_cnt;       // frames * channels
+  double buf_step;
+  t_systhread buf_thread;
+  void* buf_qelem;
+
+  // Attributes
+  char a_verbose;
+  t_atom_long a_maxlen;
+  t_atom_long a_chunk;  // 0 when off
+  char a_markers;
+#ifdef ROUND_STEP
+  double a_step;
+#endif
+
+} t_rounding;
+
+//******************************************************************************
+//  Global pointer to the class.
+//
+static t_class* rounding_class = NULL;
+
+//==============================================================================
+//  Function declarations
+//==============================================================================
+
+// Object methods
+void* rounding_new(t_symbol* sym, long argc, t_atom* argv);
+void  rounding_free(t_rounding* x);
+void  rounding_assist(t_rounding* x, void* b, long msg, long arg, char* str);
+void  rounding_int(t_rounding* x, long val);
+void  rounding_float(t_rounding* x, double val);
+void  rounding_list(t_rounding* x, t_symbol* sym, long argc, t_atom* argv);
+void  rounding_anything(t_rounding* x, t_symbol* sym, long argc, t_atom* argv);
+void  rounding_jit_matrix(t_rounding* x, t_symbol* name);
+void  rounding_dictionary(t_rounding* x, t_symbol* name);
+void  rounding_buffer(t_rounding* x, t_symbol* sym, long argc, t_atom* argv);
+t_max_err rounding_notify(t_rounding* x, t_symbol* sym, t_symbol* msg,
+    void* sender, void* data);
+
+// Attribute setters
+t_max_err a_set_maxlen(t_rounding* x, t_object* attr, long argc,
+    t_atom* argv);
+t_max_err a_set_chunk(t_rounding* x, t_object* attr, long argc, t_atom* argv);
+#ifdef ROUND_STEP
+t_max_err a_set_step(t_rounding* x, t_object* attr, long argc, t_atom* argv);
+#endif
+
+// Process lists and messages
+t_bool reserve_atoms(t_rounding* x, long argc);
+void process_message(t_rounding* x, t_symbol* sym, long argc, t_atom* argv,
+    t_output_func output);
+void process_chunks(t_rounding* x, t_symbol* sym, long argc, t_atom* argv,
+    t_output_func output);
+void process_block(t_rounding* x, t_symbol* sym, long argc, t_atom* argv,
+    t_output_func output);
+void process_atoms(t_rounding* x, t_atom* argv, t_atom* atoms, long first,
+    long argc);
+
+// Process Jitter matrices
+void process_matrix_ndim(t_rounding* x, long dimcount, long* dim,
+    long planecount, t_jit_matrix_info* minfo, char* bp);
+
+// Process dictionaries
+void process_dictionary(t_rounding* x, t_dictionary* dict);
+void process_atoms_in_place(t_rounding* x, t_atom* argv, long argc);
+
+// Process buffer~ objects
+void* buffer_job(t_rounding* x);
+void* buffer_part_job(t_buffer_part* part);
+void buffer_process(t_rounding* x);
+void buffer_release(t_rounding* x);
+void buffer_done(t_rounding* x);
+
+//******************************************************************************
+//  Write a result to an atom: a float with a step, a long otherwise.
+//
+static inline void set_result(t_atom* atom, double val) {
+
+#ifdef ROUND_STEP
+  atom->a_type = A_FLOAT;
+  atom->a_w.w_float = val;
+#else
+  atom->a_type = A_LONG;
+  atom->a_w.w_long = (t_atom_long)val;
+#endif
+}
+
+//******************************************************************************
+//  Process one atom.
+//
+static inline void process_atom(t_rounding* x, t_atom* atom_in,
+    t_atom* atom_out) {
+
+  switch (atom_gettype(atom_in)) {
+    case A_LONG:
+#ifdef ROUND_STEP
+      set_result(atom_out, ROUND_SCALAR(x, (double)atom_getlong(atom_in)));
+#else
+      atom_setlong(atom_out, atom_getlong(atom_in));
+#endif
+      break;
+    case A_FLOAT:
+      set_result(atom_out, ROUND_SCALAR(x, atom_getfloat(atom_in)));
+      break;
+    case A_SYM:
+      atom_setsym(atom_out, atom_getsym(atom_in));
+      break;
+    default:
+      atom_setsym(atom_out, gensym("<error>"));
+      break;
+  }
+}
+
+//******************************************************************************
+//  Test if an atom is output unchanged.
+//
+static inline t_bool is_unchanged(t_atom* atom) {
+
+#ifdef ROUND_STEP
+  return (atom_gettype(atom) == A_SYM);
+#else
+  return (atom_gettype(atom) == A_LONG) || (atom_gettype(atom) == A_SYM);
+#endif
+}
+
+//******************************************************************************
+//  Apply the operation to an array of values, in place.
+//
+static inline void round_run(t_rounding* x, double* vals, long cnt) {
+
+  long i = 0;
+#ifdef ROUND_VECTOR
+  for (; i + ROUND_VEC_LEN <= cnt; i += ROUND_VEC_LEN) {
+    VEC_STORE(vals + i, ROUND_VECTOR(x, VEC_LOAD(vals + i)));
+  }
+#endif
+  for (; i < cnt; i++) {
+    vals[i] = ROUND_SCALAR(x, vals[i]);
+  }
+}
+
+//==============================================================================
+//  Class definition and life cycle
+//==============================================================================
+
+//******************************************************************************
+//  Create the Max class and initialize it.
+//
+void C74_EXPORT ext_main(void* r) {
+
+  t_class* c;
+
+  c = class_new(
+    "y." ROUND_NAME,
+    (method)rounding_new,
+    (method)rounding_free,
+    (long)sizeof(t_rounding),
+    (method)NULL,
+    A_GIMME,
+    0);
+
+  class_addmethod(c, (method)rounding_assist, "assist", A_CANT, 0);
+  class_addmethod(c, (method)rounding_int, "int", A_LONG, 0);
+  class_addmethod(c, (method)rounding_float, "float", A_FLOAT, 0);
+  class_addmethod(c, (method)rounding_list, "list", A_GIMME, 0);
+  class_addmethod(c, (method)rounding_anything, "anything", A_GIMME, 0);
+  class_addmethod(c, (method)rounding_jit_matrix, "jit_matrix", A_SYM, 0);
+  class_addmethod(c, (method)rounding_dictionary, "dictionary", A_SYM, 0);
+  class_addmethod(c, (method)rounding_buffer, "buffer", A_GIMME, 0);
+  class_addmethod(c, (method)rounding_notify, "notify", A_CANT, 0);
+
+  // Attribute: max list length, as a safety cap
+  CLASS_ATTR_ATOM_LONG(c, "maxlen", 0, t_rounding, a_maxlen);
+  CLASS_ATTR_ORDER(c, "maxlen", 0, "1");
+  CLASS_ATTR_LABEL(c, "maxlen", 0, "Max list length");
+  CLASS_ATTR_SAVE(c, "maxlen", 0);
+  CLASS_ATTR_SELFSAVE(c, "maxlen", 0);
+  CLASS_ATTR_ACCESSORS(c, "maxlen", NULL, a_set_maxlen);
+
+  // Attribute: to turn warnings on or off
+  CLASS_ATTR_CHAR(c, "verbose", 0, t_rounding, a_verbose);
+  CLASS_ATTR_ORDER(c, "verbose", 0, "2");
+  CLASS_ATTR_STYLE(c, "verbose", 0, "onoff");
+  CLASS_ATTR_LABEL(c, "verbose", 0, "Report warnings");
+  CLASS_ATTR_SAVE(c, "verbose", 0);
+  CLASS_ATTR_SELFSAVE(c, "verbose", 0);
+
+  // Attribute: chunk size to split long messages, 0 to clip them to maxlen
+  CLASS_ATTR_ATOM_LONG(c, "chunk", 0, t_rounding, a_chunk);
+  CLASS_ATTR_ORDER(c, "chunk", 0, "3");
+  CLASS_ATTR_LABEL(c, "chunk", 0, "Chunk size");
+  CLASS_ATTR_SAVE(c, "chunk", 0);
+  CLASS_ATTR_SELFSAVE(c, "chunk", 0);
+  CLASS_ATTR_ACCESSORS(c, "chunk", NULL, a_set_chunk);
+
+  // Attribute: to frame the chunks with begin and end messages
+  CLASS_ATTR_CHAR(c, "markers", 0, t_rounding, a_markers);
+  CLASS_ATTR_ORDER(c, "markers", 0, "4");
+  CLASS_ATTR_STYLE(c, "markers", 0, "onoff");
+  CLASS_ATTR_LABEL(c, "markers", 0, "Chunk markers");
+  CLASS_ATTR_SAVE(c, "markers", 0);
+  CLASS_ATTR_SELFSAVE(c, "markers", 0);
+
+#ifdef ROUND_STEP
+  // Attribute: step to snap the values to
+  CLASS_ATTR_DOUBLE(c, "step", 0, t_rounding, a_step);
+  CLASS_ATTR_ORDER(c, "step", 0, "0");
+  CLASS_ATTR_LABEL(c, "step", 0, "Step size");
+  CLASS_ATTR_SAVE(c, "step", 0);
+  CLASS_ATTR_SELFSAVE(c, "step", 0);
+  CLASS_ATTR_ACCESSORS(c, "step", NULL, a_set_step);
+#endif
+
+  class_register(CLASS_BOX, c);
+  rounding_class = c;
+}
+
+//******************************************************************************
+//  Attribute setter for maxlen.
+//
+//  The cap is a number up to SHRT_MAX. The symbols of the former modes are
+//  still accepted: 'max' and 'auto' set the highest cap.
+//
+t_max_err a_set_maxlen(t_rounding* x, t_object* attr, long argc,
+    t_atom* argv) {
+
+  // Input could be a symbol or an integer
+  t_atom_long number = 0;
+
+  switch (argc ? atom_gettype(argv) : A_NOTHING) {
+  case A_LONG:
+  case A_FLOAT:
+    number = atom_getlong(argv);
+    break;
+  case A_SYM:
+    if ((atom_getsym(argv) == gensym("max"))
+      || (atom_getsym(argv) == gensym("auto"))) {
+      number = SHRT_MAX;
+    }
+    else {
+      number = atol(atom_getsym(argv)->s_name);
+    }
+    break;
+  }
+
+  if ((number < 1) || (number > SHRT_MAX)) {
+    WARN("maxlen: use a length from 1 to %i, or max.", SHRT_MAX);
+    return MAX_ERR_NONE;
+  }
+
+  x->a_maxlen = number;
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Attribute setter for the chunk size.
+//
+t_max_err a_set_chunk(t_rounding* x, t_object* attr, long argc, t_atom* argv) {
+
+  t_atom_long chunk = argc ? atom_getlong(argv) : 0;
+  if ((chunk < 0) || (chunk > SHRT_MAX)) {
+    WARN("chunk: use a size from 1 to %i, or 0 for off.", SHRT_MAX);
+    return MAX_ERR_NONE;
+  }
+
+  x->a_chunk = chunk;
+  return MAX_ERR_NONE;
+}
+
+#ifdef ROUND_STEP
+//******************************************************************************
+//  Attribute setter for the step.
+//
+t_max_err a_set_step(t_rounding* x, t_object* attr, long argc, t_atom* argv) {
+
+  double step = argc ? atom_getfloat(argv) : 1.0;
+  if (step <= 0) {
+    WARN("step: Expects a value above 0.");
+    return MAX_ERR_NONE;
+  }
+
+  x->a_step = step;
+  return MAX_ERR_NONE;
+}
+#endif
+
+//******************************************************************************
+//  Create a new instance of the class.
+//
+void* rounding_new(t_symbol* sym, long argc, t_atom* argv) {
+
+  t_rounding* x = NULL;
+
+  x = (t_rounding*)object_alloc(rounding_class);
+
+  if (x == NULL) {
+    error(ROUND_NAME ": Object allocation failed.");
+    return NULL;
+  }
+
+  x->outl_output = outlet_new(x, NULL);
+
+  x->atoms_size = 0;
+  x->shrink_cnt = 0;
+  x->shrink_max = 0;
+  x->atoms = (t_atom*)sysmem_newptr(ATOMS_SIZE_MIN * sizeof(t_atom));
+  if (!x->atoms) {
+    object_free(x);
+    error(ROUND_NAME ": Allocation failed.");
+    return NULL;
+  }
+  x->atoms_size = ATOMS_SIZE_MIN;
+
+#ifdef ROUND_STEP
+  x->a_step = 1.0;
+#endif
+  object_attr_setlong(x, gensym("maxlen"), SHRT_MAX);
+  object_attr_setchar(x, gensym("verbose"), 1);
+  object_attr_setlong(x, gensym("chunk"), 0);
+  object_attr_setchar(x, gensym("markers"), 0);
+  attr_args_process(x, (short)argc, argv);
+
+  x->buf_qelem = qelem_new(x, (method)buffer_done);
+
+  return x;
+}
+
+//******************************************************************************
+//  Free the instance.
+//
+void rounding_free(t_rounding* x) {
+
+  // Wait for a buffer~ job, and release the buffer~ without output
+  if (x->buf_thread) { buffer_release(x); }
+  if (x->buf_qelem) { qelem_free(x->buf_qelem); }
+  if (x->buf_ref) { object_free(x->buf_ref); }
+  x->buf_qelem = NULL;
+  x->buf_ref = NULL;
+
+  if (x->atoms) { sysmem_freeptr(x->atoms); }
+  x->atoms = NULL;
+}
+
+//******************************************************************************
+//  Assist function.
+//
+void rounding_assist(t_rounding* x, void* b, long msg, long arg, char* str) {
+
+  if (msg == ASSIST_INLET) {
+    switch (arg) {
+    case 0:
+      sprintf(str, "Numbers, matrix or dictionary to be " ROUND_DESC ".");
+      break;
+    default:
+      break;
+    }
+  }
+
+  else if (msg == ASSIST_OUTLET) {
+    switch (arg) {
+    case 0:
+      sprintf(str, ROUND_DESC " values. Symbols are passed unchanged.");
+      str[0] = (char)toupper(str[0]);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+//******************************************************************************
+//  Process incoming integers.
+//
+void rounding_int(t_rounding* x, long val) {
+
+#ifdef ROUND_STEP
+  outlet_float(x->outl_output, ROUND_SCALAR(x, (double)val));
+#else
+  outlet_int(x->outl_output, val);
+#endif
+}
+
+//******************************************************************************
+//  Process incoming floats.
+//
+void rounding_float(t_rounding* x, double val) {
+
+#ifdef ROUND_STEP
+  outlet_float(x->outl_output, ROUND_SCALAR(x, val));
+#else
+  outlet_int(x->outl_output, (t_atom_long)ROUND_SCALAR(x, val));
+#endif
+}
+
+//******************************************************************************
+//  Process incoming lists.
+//
+void rounding_list(t_rounding* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  process_message(x, sym, argc, argv, outlet_list);
+}
+
+//******************************************************************************
+//  Process incoming messages.
+//
+void rounding_anything(t_rounding* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  process_message(x, sym, argc, argv, outlet_anything);
+}
+
+//******************************************************************************
+//  Make room for a message in the output atoms.
+//
+//  The buffer grows to hold the longest message seen. It shrinks to the
+//  longest message of a run of SHRINK_RUN messages that would all have fit
+//  in a quarter of it, so that it does not resize back and forth.
+//
+//  @return false on allocation failure, with the buffer unchanged.
+//
+t_bool reserve_atoms(t_rounding* x, long argc) {
+
+  long size = 0;
+
+  if (argc > x->atoms_size) {
+    size = MIN(MAX(argc, x->atoms_size + x->atoms_size / 2), SHRT_MAX);
+    x->shrink_cnt = 0;
+  }
+  else if ((argc <= x->atoms_size / 4) && (x->atoms_size > ATOMS_SIZE_MIN)) {
+    x->shrink_max = (x->shrink_cnt++) ? MAX(x->shrink_max, argc) : argc;
+    if (x->shrink_cnt == SHRINK_RUN) {
+      size = MAX(x->shrink_max, ATOMS_SIZE_MIN);
+      x->shrink_cnt = 0;
+    }
+  }
+  else {
+    x->shrink_cnt = 0;
+  }
+
+  if (size) {
+    t_atom* atoms = (t_atom*)sysmem_resizeptr(x->atoms, size * sizeof(t_atom));
+    if (!atoms) { return (argc <= x->atoms_size); }
+    x->atoms = atoms;
+    x->atoms_size = size;
+  }
+  return true;
+}
+
+//******************************************************************************
+//  Process a list or message and output it.
+//
+void process_message(t_rounding* x, t_symbol* sym, long argc, t_atom* argv,
+    t_output_func output) {
+
+  if (x->a_chunk) {
+    process_chunks(x, sym, argc, argv, output);
+    return;
+  }
+
+  if (argc > x->a_maxlen) {
+    if (x->a_verbose) {
+      WARN("Max list length exceeded: %i clipped to %i", argc,
+        (int)x->a_maxlen);
+    }
+    argc = (long)x->a_maxlen;
+  }
+
+  process_block(x, sym, argc, argv, output);
+}
+
+//******************************************************************************
+//  Process a message of any length in chunks, and output them in order.
+//
+//  Each chunk is output with the selector of the message. With markers on,
+//  a message split in several chunks is framed by 'begin <length>' and
+//  'end' messages. The output atoms never grow beyond the chunk size.
+//
+void process_chunks(t_rounding* x, t_symbol* sym, long argc, t_atom* argv,
+    t_output_func output) {
+
+  long chunk = (long)x->a_chunk;
+
+  if (argc <= chunk) {
+    process_block(x, sym, argc, argv, output);
+    return;
+  }
+
+  t_atom length;
+  if (x->a_markers) {
+    atom_setlong(&length, argc);
+    outlet_anything(x->outl_output, gensym("begin"), 1, &length);
+  }
+
+  for (long i = 0; i < argc; i += chunk) {
+    process_block(x, sym, MIN(chunk, argc - i), argv + i, output);
+  }
+
+  if (x->a_markers) {
+    outlet_anything(x->outl_output, gensym("end"), 0, NULL);
+  }
+}
+
+//******************************************************************************
+//  Process a block of at most SHRT_MAX atoms and output it.
+//
+void process_block(t_rounding* x, t_symbol* sym, long argc, t_atom* argv,
+    t_output_func output) {
+
+  // Pre-scan for the first atom that changes
+  long first = 0;
+  while ((first < argc) && is_unchanged(argv + first)) {
+    first++;
+  }
+
+  // Nothing to change: output the input atoms without copying them
+  if (first == argc) {
+    output(x->outl_output, sym, (short)argc, argv);
+    return;
+  }
+
+  if (!reserve_atoms(x, argc)) {
+    WARN("Allocation failed: %i clipped to %i", argc, x->atoms_size);
+    argc = x->atoms_size;
+    first = MIN(first, argc);
+  }
+
+  // Copy the unchanged prefix as a block, then process the rest
+  memcpy(x->atoms, argv, first * sizeof(t_atom));
+  process_atoms(x, argv, x->atoms, first, argc);
+  output(x->outl_output, sym, (short)argc, x->atoms);
+}
+
+//******************************************************************************
+//  Process atoms, rounding the runs of floats in blocks.
+//
+//  The floats of a run are gathered into an array, rounded by the vector
+//  kernel, and written back. The atom fields are accessed directly to keep
+//  the loops free of function calls.
+//
+void process_atoms(t_rounding* x, t_atom* argv, t_atom* atoms, long first,
+    long argc) {
+
+  double vals[RUN_CHUNK];
+  long i = first;
+
+  while (i < argc) {
+    if (atom_gettype(argv + i) != A_FLOAT) {
+      process_atom(x, argv + i, atoms + i);
+      i++;
+      continue;
+    }
+
+    // Find the end of the run of floats, and round it in chunks
+    long end = i + 1;
+    while ((end < argc) && (atom_gettype(argv + end) == A_FLOAT)) {
+      end++;
+    }
+    while (i < end) {
+      long cnt = MIN(end - i, RUN_CHUNK);
+      for (long k = 0; k < cnt; k++) {
+        vals[k] = argv[i + k].a_w.w_float;
+      }
+      round_run(x, vals, cnt);
+      for (long k = 0; k < cnt; k++) {
+        set_result(atoms + i + k, vals[k]);
+      }
+      i += cnt;
+    }
+  }
+}
+
+//******************************************************************************
+//  Process incoming Jitter matrices, in place.
+//
+//  The rows are shared among the Jitter worker threads, each row holding
+//  all the planes of its cells. Matrices of other types are passed on
+//  unchanged: their values are integers already.
+//
+void rounding_jit_matrix(t_rounding* x, t_symbol* name) {
+
+  void* matrix = jit_object_findregistered(name);
+  if (!matrix || !jit_object_method(matrix, _jit_sym_class_jit_matrix)) {
+    WARN("jit_matrix: No matrix named %s.", name->s_name);
+    return;
+  }
+
+  long lock = (long)jit_object_method(matrix, _jit_sym_lock, 1);
+
+  t_jit_matrix_info info;
+  char* bp = NULL;
+  jit_object_method(matrix, _jit_sym_getinfo, &info);
+  jit_object_method(matrix, _jit_sym_getdata, &bp);
+
+  if (!bp) {
+    WARN("jit_matrix: The matrix has no data.");
+  }
+  else if ((info.type == _jit_sym_float32) || (info.type == _jit_sym_float64)) {
+    jit_parallel_ndim_simplecalc1((method)process_matrix_ndim, x,
+      info.dimcount, info.dim, info.planecount, &info, bp, 0);
+  }
+#ifdef ROUND_STEP
+  else {
+    WARN("jit_matrix: Only float32 and float64 matrices are quantized.");
+  }
+#endif
+
+  jit_object_method(matrix, _jit_sym_lock, lock);
+
+  t_atom atom;
+  atom_setsym(&atom, name);
+  outlet_anything(x->outl_output, _jit_sym_jit_matrix, 1, &atom);
+}
+
+//******************************************************************************
+//  Round a float32 row in place, converting it to doubles in chunks.
+//
+static inline void round_row_float32(t_rounding* x, float* row, long cnt) {
+
+  double vals[RUN_CHUNK];
+
+  for (long i = 0; i < cnt; i += RUN_CHUNK) {
+    long len = MIN(cnt - i, RUN_CHUNK);
+    for (long k = 0; k < len; k++) {
+      vals[k] = row[i + k];
+    }
+    round_run(x, vals, len);
+    for (long k = 0; k < len; k++) {
+      row[i + k] = (float)vals[k];
+    }
+  }
+}
+
+//******************************************************************************
+//  Round the part of a matrix given to a worker thread, in place.
+//
+//  Called by jit_parallel_ndim_simplecalc1() on a slice of the matrix, and
+//  recursively on each of its outer dimensions down to the rows.
+//
+void process_matrix_ndim(t_rounding* x, long dimcount, long* dim,
+    long planecount, t_jit_matrix_info* minfo, char* bp) {
+
+  if (dimcount < 1) { return; }
+
+  if (dimcount > 2) {
+    for (long i = 0; i < dim[dimcount - 1]; i++) {
+      process_matrix_ndim(x, dimcount - 1, dim, planecount, minfo,
+        bp + i * minfo->dimstride[dimcount - 1]);
+    }
+    return;
+  }
+
+  long rows = (dimcount == 2) ? dim[1] : 1;
+  long stride = (dimcount == 2) ? minfo->dimstride[1] : 0;
+  t_bool is_64 = (minfo->type == _jit_sym_float64);
+  long elem = is_64 ? sizeof(double) : sizeof(float);
+
+  for (long j = 0; j < rows; j++) {
+    char* row = bp + j * stride;
+
+    // Packed cells: one run over all the planes of the row
+    if (minfo->dimstride[0] == planecount * elem) {
+      if (is_64) { round_run(x, (double*)row, dim[0] * planecount); }
+      else { round_row_float32(x, (float*)row, dim[0] * planecount); }
+      continue;
+    }
+
+    // Padded cells: each cell on its own
+    for (long i = 0; i < dim[0]; i++) {
+      char* cell = row + i * minfo->dimstride[0];
+      if (is_64) { round_run(x, (double*)cell, planecount); }
+      else { round_row_float32(x, (float*)cell, planecount); }
+    }
+  }
+}
+
+//******************************************************************************
+//  Process incoming dictionaries, in place.
+//
+//  The numbers are rounded where they are stored, and the name passed on,
+//  so that the values are neither copied into lists nor limited by maxlen.
+//
+void rounding_dictionary(t_rounding* x, t_symbol* name) {
+
+  t_dictionary* dict = dictobj_findregistered_retain(name);
+  if (!dict) {
+    WARN("dictionary: No dictionary named %s.", name->s_name);
+    return;
+  }
+
+  process_dictionary(x, dict);
+  dictobj_release(dict);
+
+  t_atom atom;
+  atom_setsym(&atom, name);
+  outlet_anything(x->outl_output, gensym("dictionary"), 1, &atom);
+}
+
+//******************************************************************************
+//  Round the values of a dictionary in place, recursively.
+//
+//  The atoms of atom arrays are modified directly. Single values are
+//  replaced only when they change.
+//
+void process_dictionary(t_rounding* x, t_dictionary* dict) {
+
+  long key_cnt = 0;
+  t_symbol** keys = NULL;
+  dictionary_getkeys(dict, &key_cnt, &keys);
+
+  for (long k = 0; k < key_cnt; k++) {
+    if (dictionary_entryisatomarray(dict, keys[k])) {
+      t_object* array = NULL;
+      long argc = 0;
+      t_atom* argv = NULL;
+      dictionary_getatomarray(dict, keys[k], &array);
+      atomarray_getatoms((t_atomarray*)array, &argc, &argv);
+      process_atoms_in_place(x, argv, argc);
+    }
+    else if (dictionary_entryisdictionary(dict, keys[k])) {
+      t_object* sub = NULL;
+      dictionary_getdictionary(dict, keys[k], &sub);
+      process_dictionary(x, (t_dictionary*)sub);
+    }
+    else {
+      t_atom atom;
+      dictionary_getatom(dict, keys[k], &atom);
+      if (((atom_gettype(&atom) == A_LONG) || (atom_gettype(&atom) == A_FLOAT))
+        && !is_unchanged(&atom)) {
+        process_atom(x, &atom, &atom);
+        dictionary_appendatom(dict, keys[k], &atom);
+      }
+    }
+  }
+
+  if (keys) { dictionary_freekeys(dict, key_cnt, keys); }
+}
+
+//******************************************************************************
+//  Round the numbers of an atom array in place.
+//
+//  The runs of numbers go through the list loop, and the dictionaries held
+//  in the array are processed recursively. Other atoms are left as they are.
+//
+void process_atoms_in_place(t_rounding* x, t_atom* argv, long argc) {
+
+  long i = 0;
+
+  while (i < argc) {
+    long end = i;
+    while ((end < argc) && ((atom_gettype(argv + end) == A_FLOAT)
+      || (atom_gettype(argv + end) == A_LONG))) {
+      end++;
+    }
+    if (end > i) {
+      process_atoms(x, argv, argv, i, end);
+      i = end;
+      continue;
+    }
+
+    if (atom_gettype(argv + i) == A_OBJ) {
+      t_object* obj = (t_object*)atom_getobj(argv + i);
+      if (obj && (object_classname(obj) == gensym("dictionary"))) {
+        process_dictionary(x, (t_dictionary*)obj);
+      }
+    }
+    i++;
+  }
+}
+
+//******************************************************************************
+//  Round the samples of a buffer~ in place: buffer <name> [step]
+//
+//  The values are rounded to multiples of the step, 1 by default, or the
+//  step attribute for y.quantize. The buffer~ is locked, and rounded by a
+//  job thread, itself sharing large buffers with more threads. When done,
+//  the buffer~ is notified and unlocked, and 'done <name>' is output.
+//
+void rounding_buffer(t_rounding* x, t_symbol* sym, long argc, t_atom* argv) {
+
+  if (x->buf_thread) {
+    WARN("buffer: Still rounding %s.", x->buf_name->s_name);
+    return;
+  }
+  if (!argc || (atom_gettype(argv) != A_SYM)) {
+    WARN("buffer: Expects a buffer~ name and an optional step.");
+    return;
+  }
+
+#ifdef ROUND_STEP
+  double step = (argc > 1) ? atom_getfloat(argv + 1) : x->a_step;
+#else
+  double step = (argc > 1) ? atom_getfloat(argv + 1) : 1.0;
+#endif
+  if (step <= 0) {
+    WARN("buffer: Expects a step above 0.");
+    return;
+  }
+
+  t_symbol* name = atom_getsym(argv);
+  if (!x->buf_ref) { x->buf_ref = buffer_ref_new((t_object*)x, name); }
+  else { buffer_ref_set(x->buf_ref, name); }
+
+  t_buffer_obj* obj = buffer_ref_getobject(x->buf_ref);
+  if (!obj) {
+    WARN("buffer: No buffer~ named %s.", name->s_name);
+    return;
+  }
+  float* samps = buffer_locksamples(obj);
+  if (!samps) {
+    WARN("buffer: Unable to access the samples of %s.", name->s_name);
+    return;
+  }
+
+  x->buf_obj = obj;
+  x->buf_name = name;
+  x->buf_samps = samps;
+  x->buf_cnt = (long)(buffer_getframecount(obj) * buffer_getchannelcount(obj));
+  x->buf_step = step;
+
+  // Without a job thread, round on the main thread
+  if (systhread_create((method)buffer_job, x, 0, 0, 0, &x->buf_thread)) {
+    x->buf_thread = NULL;
+    buffer_process(x);
+    buffer_done(x);
+  }
+}
+
+//******************************************************************************
+//  Forward notifications to the buffer~ reference.
+//
+t_max_err rounding_notify(t_rounding* x, t_symbol* sym, t_symbol* msg,
+    void* sender, void* data) {
+
+  if (!x->buf_ref) { return MAX_ERR_NONE; }
+  return buffer_ref_notify(x->buf_ref, sym, msg, sender, data);
+}
+
+//******************************************************************************
+//  Round samples to multiples of a step, in place.
+//
+static inline void round_samples(float* samps, long cnt, double step) {
+
+  double vals[RUN_CHUNK];
+
+  for (long i = 0; i < cnt; i += RUN_CHUNK) {
+    long len = MIN(cnt - i, RUN_CHUNK);
+    for (long k = 0; k < len; k++) {
+      vals[k] = samps[i + k] / step;
+    }
+
+    long k = 0;
+#ifdef ROUND_UNIT_VEC
+    for (; k + ROUND_VEC_LEN <= len; k += ROUND_VEC_LEN) {
+      VEC_STORE(vals + k, ROUND_UNIT_VEC(VEC_LOAD(vals + k)));
+    }
+#endif
+    for (; k < len; k++) {
+      vals[k] = ROUND_UNIT(vals[k]);
+    }
+
+    for (long k = 0; k < len; k++) {
+      samps[i + k] = (float)(vals[k] * step);
+    }
+  }
+}
+
+//******************************************************************************
+//  Job thread: round the buffer~, then defer the release to the main thread.
+//
+void* buffer_job(t_rounding* x) {
+
+  buffer_process(x);
+  qelem_set(x->buf_qelem);
+  systhread_exit(0);
+  return NULL;
+}
+
+//******************************************************************************
+//  Part thread: round a part of the buffer~.
+//
+void* buffer_part_job(t_buffer_part* part) {
+
+  round_samples(part->samps, part->cnt, part->step);
+  systhread_exit(0);
+  return NULL;
+}
+
+//******************************************************************************
+//  Round the buffer~, sharing large ones among BUFFER_THREADS threads.
+//
+//  The calling thread rounds the first part, and any part whose thread
+//  could not be created.
+//
+void buffer_process(t_rounding* x) {
+
+  t_buffer_part parts[BUFFER_THREADS];
+  t_systhread threads[BUFFER_THREADS];
+  long cnt = x->buf_cnt;
+  int part_cnt = (cnt >= BUFFER_SPLIT_MIN) ? BUFFER_THREADS : 1;
+
+  for (int p = 0; p < part_cnt; p++) {
+    long start = cnt * p / part_cnt;
+    parts[p].samps = x->buf_samps + start;
+    parts[p].cnt = cnt * (p + 1) / part_cnt - start;
+    parts[p].step = x->buf_step;
+    threads[p] = NULL;
+  }
+
+  for (int p = 1; p < part_cnt; p++) {
+    if (systhread_create((method)buffer_part_job, parts + p, 0, 0, 0,
+        threads + p)) {
+      threads[p] = NULL;
+    }
+  }
+
+  unsigned int ret;
+  round_samples(parts[0].samps, parts[0].cnt, parts[0].step);
+  for (int p = 1; p < part_cnt; p++) {
+    if (threads[p]) { systhread_join(threads[p], &ret); }
+    else { round_samples(parts[p].samps, parts[p].cnt, parts[p].step); }
+  }
+}
+
+//******************************************************************************
+//  Wait for the job thread, then notify and unlock the buffer~.
+//
+void buffer_release(t_rounding* x) {
+
+  unsigned int ret;
+  if (x->buf_thread) { systhread_join(x->buf_thread, &ret); }
+  x->buf_thread = NULL;
+
+  buffer_setdirty(x->buf_obj);
+  buffer_unlocksamples(x->buf_obj);
+  x->buf_obj = NULL;
+  x->buf_samps = NULL;
+}
+
+//******************************************************************************
+//  Called on the main thread when the buffer~ is rounded.
+//
+void buffer_done(t_rounding* x) {
+
+  if (!x->buf_obj) { return; }
+  buffer_release(x);
+
+  t_atom atom;
+  atom_setsym(&atom, x->buf_name);
+  outlet_anything(x->outl_output, gensym("done"), 1, &atom);
+}
+
+#endif
@@ -0,0 +1,107 @@
+//==============================================================================
+//
+//  @file rounding_ops.h
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief The rounding operations shared by the list and signal externals.
+//
+//  Each operation has a scalar form on a double, and a vector form on a
+//  t_round_vec of ROUND_VEC_LEN doubles when ROUND_SIMD is defined: 4 with
+//  AVX, 2 with SSE4.1. MSVC only defines __AVX__, so the Visual Studio
+//  projects of the rounding externals build with /arch:AVX.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+#ifndef YC_ROUNDING_OPS_H_
+#define YC_ROUNDING_OPS_H_
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include <math.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+//==============================================================================
+//  Vector type and primitives
+//==============================================================================
+
+#if defined(__AVX__)
+
+#define ROUND_SIMD
+#define ROUND_VEC_LEN 4
+typedef __m256d t_round_vec;
+
+#define VEC_LOAD(p)         _mm256_loadu_pd(p)
+#define VEC_STORE(p, v)     _mm256_storeu_pd(p, v)
+#define VEC_SET1(a)         _mm256_set1_pd(a)
+#define VEC_AND(a, b)       _mm256_and_pd(a, b)
+#define VEC_OR(a, b)        _mm256_or_pd(a, b)
+#define VEC_ADD(a, b)       _mm256_add_pd(a, b)
+#define VEC_MUL(a, b)       _mm256_mul_pd(a, b)
+#define VEC_DIV(a, b)       _mm256_div_pd(a, b)
+#define VEC_ROUND(v, mode)  _mm256_round_pd(v, (mode) | _MM_FROUND_NO_EXC)
+
+#elif defined(__SSE4_1__)
+
+#define ROUND_SIMD
+#define ROUND_VEC_LEN 2
+typedef __m128d t_round_vec;
+
+#define VEC_LOAD(p)         _mm_loadu_pd(p)
+#define VEC_STORE(p, v)     _mm_storeu_pd(p, v)
+#define VEC_SET1(a)         _mm_set1_pd(a)
+#define VEC_AND(a, b)       _mm_and_pd(a, b)
+#define VEC_OR(a, b)        _mm_or_pd(a, b)
+#define VEC_ADD(a, b)       _mm_add_pd(a, b)
+#define VEC_MUL(a, b)       _mm_mul_pd(a, b)
+#define VEC_DIV(a, b)       _mm_div_pd(a, b)
+#define VEC_ROUND(v, mode)  _mm_round_pd(v, (mode) | _MM_FROUND_NO_EXC)
+
+#endif
+
+//******************************************************************************
+//  Round half away from zero, as round() does.
+//
+//  Adds the largest double below 0.5 with the sign of each value, then
+//  truncates. Adding 0.5 itself would round 0.49999999999999994 up.
+//
+#ifdef ROUND_SIMD
+static inline t_round_vec round_half_away_vec(t_round_vec v) {
+
+  t_round_vec sign = VEC_AND(v, VEC_SET1(-0.0));
+  t_round_vec half = VEC_OR(sign, VEC_SET1(0.49999999999999994));
+  return VEC_ROUND(VEC_ADD(v, half), _MM_FROUND_TO_ZERO);
+}
+#endif
+
+//==============================================================================
+//  Operations
+//==============================================================================
+
+#define OP_CEIL(v)              ceil(v)
+#define OP_CEIL_VEC(v)          VEC_ROUND(v, _MM_FROUND_TO_POS_INF)
+
+#define OP_FLOOR(v)             floor(v)
+#define OP_FLOOR_VEC(v)         VEC_ROUND(v, _MM_FROUND_TO_NEG_INF)
+
+#define OP_ROUND(v)             round(v)
+#define OP_ROUND_VEC(v)         round_half_away_vec(v)
+
+#define OP_TRUNC(v)             trunc(v)
+#define OP_TRUNC_VEC(v)         VEC_ROUND(v, _MM_FROUND_TO_ZERO)
+
+#define OP_QUANTIZE(v, step)    (round((v) / (step)) * (step))
+#define OP_QUANTIZE_VEC(v, step) \
+  VEC_MUL(VEC_SET1(step), round_half_away_vec(VEC_DIV(v, VEC_SET1(step))))
+
+#endif
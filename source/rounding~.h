@@ -0,0 +1,194 @@
+//==============================================================================
+//
+//  @file rounding~.h
+//  @author Yves Candau <ycandau@sfu.ca>
+//
+//  @brief The shared engine of the signal rounding externals.
+//
+//  This header is a template for a whole MSP external: it is included once
+//  by each of ceil~.c and floor~.c, after these macros are defined:
+//
+//    ROUND_NAME         The name without prefix and tilde, as a C string.
+//    ROUND_DESC         The operation for the assist strings: "rounded up".
+//    ROUND_SCALAR(x, v) The operation on a double.
+//    ROUND_VECTOR(x, v) Optional: the operation on a t_round_vec.
+//
+//  The operations are the ones of the list externals, from rounding_ops.h.
+//  The perform routine runs the vector operation over the whole signal
+//  vector, and the scalar one on the remaining samples. Each sample is read
+//  before it is written, so the input and output vectors can be the same.
+//
+//  This Source Code Form is subject to the terms of the Mozilla Public
+//  License, v. 2.0. If a copy of the MPL was not distributed with this
+//  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+//==============================================================================
+
+#ifndef YC_ROUNDING_TILDE_H_
+#define YC_ROUNDING_TILDE_H_
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "ext.h"
+#include "ext_obex.h"
+#include "z_dsp.h"
+#include "rounding_ops.h"
+#include <ctype.h>
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+// Without a vector operation, or without SIMD, only the scalar loop runs
+#if !defined(ROUND_SIMD) && defined(ROUND_VECTOR)
+#undef ROUND_VECTOR
+#endif
+
+//==============================================================================
+//  Structure declaration for the object
+//==============================================================================
+
+typedef struct _rounding_tilde {
+
+  t_pxobject obj;
+
+} t_rounding_tilde;
+
+//******************************************************************************
+//  Global pointer to the class.
+//
+static t_class* rounding_tilde_class = NULL;
+
+//==============================================================================
+//  Function declarations
+//==============================================================================
+
+void* rounding_tilde_new(t_symbol* sym, long argc, t_atom* argv);
+void  rounding_tilde_free(t_rounding_tilde* x);
+void  rounding_tilde_assist(t_rounding_tilde* x, void* b, long msg, long arg,
+  char* str);
+void  rounding_tilde_dsp64(t_rounding_tilde* x, t_object* dsp64,
+  t_int32* count, t_double samplerate, long maxvectorsize, long flags);
+void  rounding_tilde_perform64(t_rounding_tilde* x, t_object* dsp64,
+  double** ins, long numins, double** outs, long numouts,
+  long sampleframes, long flags, void* userparam);
+
+//==============================================================================
+//  Class definition and life cycle
+//==============================================================================
+
+//******************************************************************************
+//  Create the Max class and initialize it.
+//
+void C74_EXPORT ext_main(void* r) {
+
+  t_class* c;
+
+  c = class_new(
+    "y." ROUND_NAME "~",
+    (method)rounding_tilde_new,
+    (method)rounding_tilde_free,
+    (long)sizeof(t_rounding_tilde),
+    (method)NULL,
+    A_GIMME,
+    0);
+
+  class_addmethod(c, (method)rounding_tilde_assist, "assist", A_CANT, 0);
+  class_addmethod(c, (method)rounding_tilde_dsp64, "dsp64", A_CANT, 0);
+
+  class_dspinit(c);
+  class_register(CLASS_BOX, c);
+  rounding_tilde_class = c;
+}
+
+//******************************************************************************
+//  Create a new instance of the class.
+//
+void* rounding_tilde_new(t_symbol* sym, long argc, t_atom* argv) {
+
+  t_rounding_tilde* x = NULL;
+
+  x = (t_rounding_tilde*)object_alloc(rounding_tilde_class);
+
+  if (x == NULL) {
+    error(ROUND_NAME "~: Object allocation failed.");
+    return NULL;
+  }
+
+  dsp_setup((t_pxobject*)x, 1);
+  outlet_new((t_object*)x, "signal");
+
+  return x;
+}
+
+//******************************************************************************
+//  Free the instance.
+//
+void rounding_tilde_free(t_rounding_tilde* x) {
+
+  dsp_free((t_pxobject*)x);
+}
+
+//******************************************************************************
+//  Assist function.
+//
+void rounding_tilde_assist(t_rounding_tilde* x, void* b, long msg, long arg,
+  char* str) {
+
+  if (msg == ASSIST_INLET) {
+    switch (arg) {
+    case 0:
+      sprintf(str, "Signal to be " ROUND_DESC ".");
+      break;
+    default:
+      break;
+    }
+  }
+
+  else if (msg == ASSIST_OUTLET) {
+    switch (arg) {
+    case 0:
+      sprintf(str, ROUND_DESC " signal.");
+      str[0] = (char)toupper(str[0]);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+//******************************************************************************
+//  Called when the DAC is turned on.
+//
+void rounding_tilde_dsp64(t_rounding_tilde* x, t_object* dsp64,
+  t_int32* count, t_double samplerate, long maxvectorsize, long flags) {
+
+  object_method(dsp64, gensym("dsp_add64"), x, rounding_tilde_perform64, 0,
+    NULL);
+}
+
+//******************************************************************************
+//  Perform routine.
+//
+void rounding_tilde_perform64(t_rounding_tilde* x, t_object* dsp64,
+  double** ins, long numins, double** outs, long numouts,
+  long sampleframes, long flags, void* userparam) {
+
+  double* in = ins[0];
+  double* out = outs[0];
+  long n = sampleframes;
+  long i = 0;
+
+#ifdef ROUND_VECTOR
+  for (; i + ROUND_VEC_LEN <= n; i += ROUND_VEC_LEN) {
+    VEC_STORE(out + i, ROUND_VECTOR(x, VEC_LOAD(in + i)));
+  }
+#endif
+  for (; i < n; i++) {
+    out[i] = ROUND_SCALAR(x, in[i]);
+  }
+}
+
+#endif
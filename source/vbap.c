@@ -0,0 +1,340 @@
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "vbap.h"
+#include <math.h>
+
+//==============================================================================
+//  Defines
+//==============================================================================
+
+#define DEG_TO_RAD 0.0174532925199432957692
+
+#define VBAP_EPS 1e-6  // tolerance on gains and on coplanarity
+
+//==============================================================================
+//  Function definitions
+//==============================================================================
+
+//******************************************************************************
+//  Convert a direction in degrees to a unit vector.
+//
+static void vbap_dir(double azi, double ele, double* vec) {
+
+  azi *= DEG_TO_RAD;
+  ele *= DEG_TO_RAD;
+  vec[0] = cos(ele) * cos(azi);
+  vec[1] = cos(ele) * sin(azi);
+  vec[2] = sin(ele);
+}
+
+//******************************************************************************
+//  Add a speaker set, inverting its base matrix.
+//
+//  @return MAX_ERR_GENERIC if the matrix is singular, or MAX_ERR_OUT_OF_MEM.
+//
+static t_max_err vbap_add_set(t_vbap* vbap, int* cap, double* vecs,
+  int a, int b, int c) {
+
+  double* l1 = vecs + 3 * a;
+  double* l2 = vecs + 3 * b;
+  double* l3 = vecs + 3 * c;
+  double inv[9];
+  double det;
+
+  if (vbap->dim == 2) {
+    det = l1[0] * l2[1] - l1[1] * l2[0];
+    if (fabs(det) < VBAP_EPS) { return MAX_ERR_GENERIC; }
+    inv[0] = l2[1] / det;
+    inv[1] = -l1[1] / det;
+    inv[2] = -l2[0] / det;
+    inv[3] = l1[0] / det;
+  }
+  else {
+    // Cofactors of the matrix with rows l1, l2, l3
+    inv[0] = l2[1] * l3[2] - l2[2] * l3[1];
+    inv[3] = l2[2] * l3[0] - l2[0] * l3[2];
+    inv[6] = l2[0] * l3[1] - l2[1] * l3[0];
+    det = l1[0] * inv[0] + l1[1] * inv[3] + l1[2] * inv[6];
+    if (fabs(det) < VBAP_EPS) { return MAX_ERR_GENERIC; }
+    inv[1] = l1[2] * l3[1] - l1[1] * l3[2];
+    inv[4] = l1[0] * l3[2] - l1[2] * l3[0];
+    inv[7] = l1[1] * l3[0] - l1[0] * l3[1];
+    inv[2] = l1[1] * l2[2] - l1[2] * l2[1];
+    inv[5] = l1[2] * l2[0] - l1[0] * l2[2];
+    inv[8] = l1[0] * l2[1] - l1[1] * l2[0];
+    for (int i = 0; i < 9; i++) { inv[i] /= det; }
+  }
+
+  if (vbap->set_cnt == *cap) {
+    int cap_new = *cap ? 2 * *cap : 16;
+    t_vbap_set* sets = (t_vbap_set*)sysmem_resizeptr(
+      vbap->sets, cap_new * sizeof(t_vbap_set));
+    if (!sets) { return MAX_ERR_OUT_OF_MEM; }
+    vbap->sets = sets;
+    *cap = cap_new;
+  }
+
+  t_vbap_set* set = vbap->sets + vbap->set_cnt++;
+  set->spk[0] = a;
+  set->spk[1] = b;
+  set->spk[2] = c;
+  memcpy(set->inv, inv, sizeof(inv));
+  return MAX_ERR_NONE;
+}
+
+//******************************************************************************
+//  Test if a triangle is in the fan triangulation of its hull face.
+//
+//  A face with more than 3 speakers, such as the side of a cube, is
+//  triangulated once, from its lowest speaker to each edge of the polygon
+//  not touching it. The speakers are ordered by angle around the center
+//  of the face, in the plane of normal n.
+//
+static t_bool vbap_face_fan(double* vecs, double* n, int* face, int face_cnt,
+  int a, int b, int c) {
+
+  if (face[0] != a) { return false; }
+
+  double ctr[3] = { 0, 0, 0 };
+  for (int i = 0; i < face_cnt; i++) {
+    for (int k = 0; k < 3; k++) { ctr[k] += vecs[3 * face[i] + k] / face_cnt; }
+  }
+
+  // Basis of the plane: from the center to the lowest speaker, and normal
+  double u[3];
+  double w[3];
+  for (int k = 0; k < 3; k++) { u[k] = vecs[3 * a + k] - ctr[k]; }
+  w[0] = n[1] * u[2] - n[2] * u[1];
+  w[1] = n[2] * u[0] - n[0] * u[2];
+  w[2] = n[0] * u[1] - n[1] * u[0];
+
+  double ang_b = 0;
+  double ang_c = 0;
+  double ang[0xFF];
+  double p[3];
+  for (int i = 0; i < face_cnt; i++) {
+    for (int k = 0; k < 3; k++) { p[k] = vecs[3 * face[i] + k] - ctr[k]; }
+    ang[i] = atan2(p[0] * w[0] + p[1] * w[1] + p[2] * w[2],
+      p[0] * u[0] + p[1] * u[1] + p[2] * u[2]);
+    if (face[i] == b) { ang_b = ang[i]; }
+    if (face[i] == c) { ang_c = ang[i]; }
+  }
+
+  // The edge b c is on the polygon if no other speaker is between them
+  double lo = MIN(ang_b, ang_c);
+  double hi = MAX(ang_b, ang_c);
+  int between = 0;
+  for (int i = 0; i < face_cnt; i++) {
+    between += (ang[i] > lo) && (ang[i] < hi);
+  }
+  return (between == 0) || (between == face_cnt - 2);
+}
+
+//******************************************************************************
+//  Set a speaker layout, and calculate the speaker sets.
+//
+t_max_err vbap_set_speakers(t_vbap* vbap, int dim, int cnt,
+  double* azi, double* ele) {
+
+  vbap_clear(vbap);
+  vbap->dim = dim;
+  vbap->spk_cnt = cnt;
+  if ((cnt < dim) || (cnt > 0xFF)) { return MAX_ERR_GENERIC; }
+
+  double* vecs = (double*)sysmem_newptr(3 * cnt * sizeof(double));
+  if (!vecs) { return MAX_ERR_OUT_OF_MEM; }
+  vbap->vecs = vecs;
+  for (int i = 0; i < cnt; i++) {
+    vbap_dir(azi[i], (dim == 3) ? ele[i] : 0, vecs + 3 * i);
+  }
+
+  int cap = 0;
+  t_max_err err = MAX_ERR_NONE;
+  t_max_err ret = MAX_ERR_NONE;
+
+  // 2D: pair the speakers that are adjacent in azimuth
+  if (dim == 2) {
+    int* order = (int*)sysmem_newptr(cnt * sizeof(int));
+    if (!order) {
+      vbap_clear(vbap);
+      return MAX_ERR_OUT_OF_MEM;
+    }
+    for (int i = 0; i < cnt; i++) {
+      int j = i;
+      for (; (j > 0) && (fmod(azi[order[j - 1]] + 360, 360)
+        > fmod(azi[i] + 360, 360)); j--) {
+        order[j] = order[j - 1];
+      }
+      order[j] = i;
+    }
+    // Opposite or coincident speakers leave a gap
+    for (int i = 0; (i < cnt) && (ret != MAX_ERR_OUT_OF_MEM); i++) {
+      err = vbap_add_set(vbap, &cap, vecs, order[i], order[(i + 1) % cnt], 0);
+      if (err != MAX_ERR_NONE) { ret = err; }
+    }
+    sysmem_freeptr(order);
+  }
+
+  // 3D: keep the triangles with all the other speakers on one side
+  else {
+    int* face = (int*)sysmem_newptr(cnt * sizeof(int));
+    if (!face) {
+      vbap_clear(vbap);
+      return MAX_ERR_OUT_OF_MEM;
+    }
+    double* l1;
+    double* l2;
+    double* l3;
+    double e1[3];
+    double e2[3];
+    double n[3];
+    double d;
+    double side;
+    int above;
+    int below;
+    int face_cnt;
+
+    for (int a = 0; (a < cnt - 2) && (ret != MAX_ERR_OUT_OF_MEM); a++) {
+      for (int b = a + 1; b < cnt - 1; b++) {
+        for (int c = b + 1; c < cnt; c++) {
+          l1 = vecs + 3 * a;
+          l2 = vecs + 3 * b;
+          l3 = vecs + 3 * c;
+          for (int k = 0; k < 3; k++) {
+            e1[k] = l2[k] - l1[k];
+            e2[k] = l3[k] - l1[k];
+          }
+          n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+          n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+          n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+          if (fabs(n[0]) + fabs(n[1]) + fabs(n[2]) < VBAP_EPS) { continue; }
+          // d is also the determinant: 0 if the plane contains the listener
+          d = n[0] * l1[0] + n[1] * l1[1] + n[2] * l1[2];
+          if (fabs(d) < VBAP_EPS) { continue; }
+
+          above = 0;
+          below = 0;
+          face_cnt = 0;
+          for (int m = 0; (m < cnt) && !(above && below); m++) {
+            side = n[0] * vecs[3 * m] + n[1] * vecs[3 * m + 1]
+              + n[2] * vecs[3 * m + 2] - d;
+            above += (side > VBAP_EPS);
+            below += (side < -VBAP_EPS);
+            if (fabs(side) <= VBAP_EPS) { face[face_cnt++] = m; }
+          }
+          if ((above && below) || ((face_cnt > 3)
+            && !vbap_face_fan(vecs, n, face, face_cnt, a, b, c))) {
+            continue;
+          }
+          err = vbap_add_set(vbap, &cap, vecs, a, b, c);
+          if (err != MAX_ERR_NONE) { ret = err; }
+          if (err == MAX_ERR_OUT_OF_MEM) { break; }
+        }
+        if (ret == MAX_ERR_OUT_OF_MEM) { break; }
+      }
+    }
+    sysmem_freeptr(face);
+  }
+
+  if (ret == MAX_ERR_OUT_OF_MEM) { vbap_clear(vbap); }
+  else if (vbap->set_cnt == 0) { ret = MAX_ERR_GENERIC; }
+  return ret;
+}
+
+//******************************************************************************
+//  Free the speaker sets.
+//
+void vbap_clear(t_vbap* vbap) {
+
+  if (vbap->sets) { sysmem_freeptr(vbap->sets); }
+  if (vbap->vecs) { sysmem_freeptr(vbap->vecs); }
+  vbap->sets = NULL;
+  vbap->vecs = NULL;
+  vbap->set_cnt = 0;
+  vbap->last = 0;
+}
+
+//******************************************************************************
+//  Calculate the gains of a speaker set, and test if all are positive.
+//
+static inline t_bool vbap_set_gains(t_vbap_set* set, int dim,
+  double* p, double* gains) {
+
+  t_bool inside = true;
+  for (int j = 0; j < dim; j++) {
+    gains[j] = 0;
+    for (int i = 0; i < dim; i++) {
+      gains[j] += p[i] * set->inv[i * dim + j];
+    }
+    inside = inside && (gains[j] >= -VBAP_EPS);
+  }
+  return inside;
+}
+
+//******************************************************************************
+//  Calculate the gains for a source direction.
+//
+int vbap_pan(t_vbap* vbap, double azi, double ele, int* spk, double* gains) {
+
+  if (vbap->set_cnt == 0) { return 0; }
+
+  int dim = vbap->dim;
+  double p[3];
+  vbap_dir(azi, (dim == 3) ? ele : 0, p);
+
+  // Start from the last set used, as sources tend to move continuously
+  int found = vbap_set_gains(vbap->sets + vbap->last, dim, p, gains)
+    ? vbap->last : -1;
+
+  // Otherwise search all the sets, keeping the closest one as fallback
+  double g[3];
+  double g_min;
+  double best = -HUGE_VAL;
+  int best_set = vbap->last;
+  for (int s = 0; (s < vbap->set_cnt) && (found < 0); s++) {
+    if (vbap_set_gains(vbap->sets + s, dim, p, g)) { found = s; }
+    g_min = g[0];
+    for (int j = 1; j < dim; j++) { g_min = MIN(g_min, g[j]); }
+    if (g_min > best) {
+      best = g_min;
+      best_set = s;
+    }
+  }
+  if (found < 0) { found = best_set; }
+  if (found != vbap->last) {
+    vbap_set_gains(vbap->sets + found, dim, p, gains);
+    vbap->last = found;
+  }
+
+  // Clip and normalize to unit power
+  double power = 0;
+  for (int j = 0; j < dim; j++) {
+    if (gains[j] < 0) { gains[j] = 0; }
+    power += gains[j] * gains[j];
+  }
+
+  // Or use the closest speaker alone if all the gains are clipped
+  if (power == 0) {
+    double dot;
+    double dot_max = -HUGE_VAL;
+    for (int i = 0; i < vbap->spk_cnt; i++) {
+      dot = p[0] * vbap->vecs[3 * i] + p[1] * vbap->vecs[3 * i + 1]
+        + p[2] * vbap->vecs[3 * i + 2];
+      if (dot > dot_max) {
+        dot_max = dot;
+        spk[0] = i;
+      }
+    }
+    gains[0] = 1;
+    return 1;
+  }
+
+  power = 1 / sqrt(power);
+  for (int j = 0; j < dim; j++) {
+    gains[j] *= power;
+    spk[j] = vbap->sets[found].spk[j];
+  }
+  return dim;
+}
@@ -0,0 +1,92 @@
+#ifndef YC_VBAP_H_
+#define YC_VBAP_H_
+
+//==============================================================================
+//  Header files
+//==============================================================================
+
+#include "ext.h"
+
+//==============================================================================
+//  Typedef
+//==============================================================================
+
+//******************************************************************************
+//  A speaker pair (2D) or triangle (3D) with its inverted base matrix.
+//
+typedef struct _vbap_set {
+
+  int spk[3];
+  double inv[9];  // row major, 2 x 2 in 2D and 3 x 3 in 3D
+
+} t_vbap_set;
+
+//******************************************************************************
+//  A speaker layout, triangulated once when it is set.
+//
+typedef struct _vbap {
+
+  int dim;          // 2 or 3
+  int spk_cnt;
+  int set_cnt;
+  t_vbap_set* sets;
+  double* vecs;     // speaker unit vectors, 3 values each
+  int last;         // index of the last set used, to warm start the search
+
+} t_vbap;
+
+//==============================================================================
+//  Function declarations
+//==============================================================================
+
+//******************************************************************************
+//  Set a speaker layout, and calculate the speaker sets.
+//
+//  In 2D the speakers are paired in azimuth order. In 3D the triangles
+//  are the faces of the convex hull of the speaker directions, excluding
+//  faces whose plane contains the listener, such as the base of a dome.
+//  Faces with more than 3 speakers are triangulated once, as a fan.
+//
+//  The hull is found by testing every triangle against the other speakers,
+//  which stops at the first two on opposite sides. It runs synchronously,
+//  in a time growing with the cube of the speaker count in practice.
+//
+//  @param vbap The structure to initialize, zeroed the first time, and
+//    freed with vbap_clear().
+//  @param dim The dimension, 2 or 3.
+//  @param cnt The number of speakers, up to 255.
+//  @param azi The speaker azimuths in degrees, counter-clockwise.
+//  @param ele The speaker elevations in degrees, or NULL in 2D.
+//
+//  @return MAX_ERR_NONE, MAX_ERR_OUT_OF_MEM with the layout cleared, or
+//    MAX_ERR_GENERIC if no set could be formed, or if a 2D pair could not
+//    be inverted: speakers opposite or coincident, the other sets are kept.
+//
+t_max_err vbap_set_speakers(t_vbap* vbap, int dim, int cnt,
+  double* azi, double* ele);
+
+//******************************************************************************
+//  Free the speaker sets.
+//
+//  @param vbap The structure to clear.
+//
+void vbap_clear(t_vbap* vbap);
+
+//******************************************************************************
+//  Calculate the gains for a source direction.
+//
+//  The gains are normalized to unit power. Directions outside all the
+//  sets use the closest set, with negative gains clipped to 0, or the
+//  closest speaker alone if no gain is left.
+//
+//  @param vbap The speaker layout.
+//  @param azi The source azimuth in degrees.
+//  @param ele The source elevation in degrees, ignored in 2D.
+//  @param spk The indexes of the active speakers (3 values).
+//  @param gains The gains of the active speakers (3 values).
+//
+//  @return The number of active speakers, from 0 to 3.
+//
+int vbap_pan(t_vbap* vbap, double azi, double ele, int* spk, double* gains);
+
+#endif